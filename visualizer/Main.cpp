@@ -20,18 +20,30 @@
 #include <chrono>
 
 #include "engine.h"
+#include "thread_pool.h"
+#include "plasma.h"
+#include "dynamic_resolution.h"
+#include "texture_manager.h"
+#include "curve_kernels.h"
+#include "curve_compositor.h"
+#include "curve_script.h"
+#include "curve_validation.h"
+#include "point_cloud.h"
+#include "particle_system.h"
 
  int SCREEN_WIDTH = 900;
  int SCREEN_HEIGHT = 600;
 const int NUM_BARS = 32;
+const float TARGET_FPS = 60.0f;
 const float TWO_PI = 2.0f * static_cast<float>(M_PI);
 
  
 const float TIME_SLOWDOWN = 0.03f;  
-const int PAR = 120 ;
-
-struct Vector3D { float x, y, z; };
-struct Vector2D { float x, y; Vector2D(float _x, float _y) : x(_x), y(_y) {} };
+const int PAR = 20000;                // particle cap
+const int CLOUD_SLICES = 64;          // curve tunnel of the 3D layer: 64 x 2048 points
+const int CLOUD_SLICE_POINTS = 2048;
+const float CLOUD_DISTANCE = 3.0f;    // camera to the center of the cloud
+const float CLOUD_BEAT_TURN = 0.35f;  // radians the camera turns per kick
 
 // Audio parameters for curve
 struct AudioParams {
@@ -41,15 +53,28 @@ struct AudioParams {
     float smoothedAmplitude;
     bool beatDetected;
     float beatIntensity;
+    float kickPulse;
+    float snarePulse;
+    float hatPulse;
     float rotationSpeed;
     float globalAmplification;
 };
 
-inline float noise(float x, float y = 0.0f) {
-    float dot = x * 12.9898f + y * 78.233f;
-    float s = std::sinf(dot);
-    return s - std::floor(s); // Fast and avoids redundant computation
-}
+// Which part of the spectrum swells a curve layer
+enum class CurveBand { Bass, Mid, Treble, Amplitude };
+
+// One of the simultaneous curves. Layer 0 follows currentCurve and morphs;
+// the others keep their own type.
+struct CurveLayer {
+    int type;
+    float weight;          // alpha of glow and line
+    float rotationSpeed;   // times the audio rotation speed, negative turns the other way
+    float scale;           // of the screen-filling size
+    CurveBand band;
+    float hueOffset;       // degrees added to the palette hues
+};
+
+const int MAX_CURVE_LAYERS = 6;
 
 inline float clamp(float v, float lo, float hi) {
     return (v < lo) ? lo : (v > hi) ? hi : v;
@@ -96,104 +121,6 @@ inline SDL_Color hsbToRgb(float hue, float saturation, float brightness, float a
 }
 
 
-// Particle system with enhanced effects
-struct Particle {
-    float x, y;
-    float vx, vy;
-    float life;
-    float maxLife;
-    float size;
-    float rotation;
-    float rotationSpeed;
-    float scale;
-    float scaleSpeed;
-    float gravity;
-    SDL_Color color;
-    float frequency;
-    float amplitude;
-    enum class Shape { Circle, Rectangle, Star, Triangle, Pentagon, Hexagon } shape;
-    enum class PaletteType { PLASMA, ICE, VOLCANO, ORANGE, MYSTIC, NEON, AURORA, FOREST, COSMIC, SUNSET } palette;
-
-    Particle(float px, float py, SDL_Color c, Shape s, PaletteType p)
-        : x(px), y(py), vx(0), vy(0), life(1.0f), maxLife(1.0f),
-        size(2.0f), rotation(0.0f), rotationSpeed(0.0f), scale(1.0f), scaleSpeed(0.0f),
-        gravity(0.0f), color(c), frequency(0.1f), amplitude(10.0f), shape(s), palette(p) {
-    }
-
-    void update(float audioLevel, float beat, float deltaTime, const std::vector<Particle>& particles, size_t selfIndex) {
-        float soundForce = audioLevel * 100.0f;
-        float beatForce = beat * 600.0f;
-
-        float timeF = static_cast<float>(SDL_GetTicks()) * 0.002f;
-        vx += (std::sin(frequency * timeF) + (static_cast<float>(rand()) / RAND_MAX - 0.5f) * audioLevel) * soundForce * 0.05f;
-        vy += (std::cos(frequency * timeF) + (static_cast<float>(rand()) / RAND_MAX - 0.5f) * audioLevel) * soundForce * 0.05f;
-
-        if (beat > 0.1f) {
-            vx += (static_cast<float>(rand()) / RAND_MAX - 0.5f) * beatForce * 0.15f;
-            vy += (static_cast<float>(rand()) / RAND_MAX - 0.5f) * beatForce * 0.15f;
-            scale += 0.4f;
-        }
-
-        vx *= 0.98f;
-        vy *= 0.98f;
-
-        x += vx * deltaTime;
-        y += vy * deltaTime;
-
-        if (x - size / 2 < 0) {
-            x = size / 2;
-            vx = -vx * 0.9f;
-        }
-        else if (x + size / 2 > SCREEN_WIDTH) {
-            x = SCREEN_WIDTH - size / 2;
-            vx = -vx * 0.9f;
-        }
-        if (y - size / 2 < 0) {
-            y = size / 2;
-            vy = -vy * 0.9f;
-        }
-        else if (y + size / 2 > SCREEN_HEIGHT) {
-            y = SCREEN_HEIGHT - size / 2;
-            vy = -vy * 0.9f;
-        }
-
-        for (size_t i = 0; i < particles.size(); ++i) {
-            if (i == selfIndex) continue;
-            const auto& other = particles[i];
-            float dx = x - other.x;
-            float dy = y - other.y;
-            float distance = std::sqrt(dx * dx + dy * dy);
-            float minDistance = (size + other.size) / 2;
-
-            if (distance < minDistance && distance > 0) {
-                float angle = std::atan2(dy, dx);
-                float overlap = minDistance - distance;
-                float moveX = std::cos(angle) * overlap * 0.5f;
-                float moveY = std::sin(angle) * overlap * 0.5f;
-
-                x += moveX;
-                y += moveY;
-
-                float tempVx = vx;
-                float tempVy = vy;
-                vx = other.vx * 0.9f + (beat > 0.1f ? (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 75.0f : 0.0f);
-                vy = other.vy * 0.9f + (beat > 0.1f ? (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 75.0f : 0.0f);
-            }
-        }
-
-        life -= 0.005f * deltaTime * 60.0f;
-        if (life < 0) life = 0;
-
-        color.a = static_cast<Uint8>(life * 255.0f);
-        size = 2.0f + audioLevel * 7.0f + beat * 5.0f;
-
-        rotation += rotationSpeed * deltaTime;
-        scale = (std::max)(0.5f, (std::min)(scale, 2.0f));
-    }
-
-    bool isAlive() const { return life > 0; }
-};
-
 // Wave pattern for background
 struct Wave {
     float amplitude;
@@ -220,16 +147,21 @@ class SimpleVisualizer {
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
-    SDL_Texture* curveTexture; // Texture for curve rendering
+    TextureManager textures; // render targets and streaming textures, by slot
     AudioEngine engine;
+    ThreadPool workerPool;
+    PlasmaRenderer plasmaRenderer;
+    DynamicResolution resolution{ TARGET_FPS }; // internal scale of the procedural layers
 
     std::vector<float> barHeights;
     std::vector<float> targetHeights;
     float backgroundIntensity;
+    float barBeatBoost;       // beat lift of the lowest bars, eased like the old bars
     float wavePhase;
     bool running;
 
-    std::vector<Particle> particles;
+    ParticleSystem particles{ PAR };
+    CurveGeometry particleGeometry;    // every particle in one draw call
     std::vector<Wave> backgroundWaves;
     std::vector<std::vector<SDL_Color>> palettes = {
         {{200, 0, 255, 150}, {150, 0, 200, 150}, {100, 50, 255, 150}, {180, 0, 180, 150}},
@@ -255,10 +187,36 @@ private:
     int width = SCREEN_WIDTH;
     int height = SCREEN_HEIGHT;
     int currentCurve = 0;
+    std::string curveScriptPath = "curves.txt";
     AudioParams audioParams;
+    unsigned int lastKickCount = 0;
+    unsigned int lastSnareCount = 0;
+    unsigned int lastSectionCount = 0;
+    bool sectionChangePending = false; // consumed by plasma() to switch palette
+    bool plasmaBeatRefresh = true;     // full plasma refresh on kicks when interlaced
+    std::vector<CurveLayer> curveLayers = {
+        { 0, 0.9f, 1.0f, 1.0f, CurveBand::Mid, 0.0f },
+        { 3, 0.6f, -0.7f, 0.7f, CurveBand::Bass, 60.0f },
+        { 10, 0.5f, 1.6f, 1.25f, CurveBand::Treble, 180.0f },
+        { 4, 0.45f, -1.3f, 0.5f, CurveBand::Amplitude, 270.0f },
+        { 21, 0.4f, 0.8f, 0.85f, CurveBand::Bass, 120.0f },
+        { 2, 0.35f, -2.0f, 1.4f, CurveBand::Mid, 300.0f }
+    };
+    int curveLayerCount = 1;
+    std::vector<CurveLayerFrame> curveFrames;
+    CurveCompositor curveCompositor;   // all layers in parallel, one draw call
+    CurveMorph curveMorph{ TIME_SLOWDOWN };
+    int pendingCurve = -1;             // waiting for the next kick to morph to
+    float pendingWait = 0.0f;
+    float lastKickTime = 0.0f;         // in curve time t
+    float kickInterval = 0.5f;         // smoothed, sets the morph length
+    PointCloud pointCloud;             // 3D layer: the curve as a tunnel, the particles inside it
+    bool pointCloudEnabled = false;
+    std::vector<float> cloudTheta;
+    unsigned int cloudBeats = 0;       // kicks so far; the camera turns a step on each
 
 public:
-    SimpleVisualizer() : window(nullptr), renderer(nullptr), curveTexture(nullptr), running(false), backgroundIntensity(0.0f), wavePhase(0.0f) {
+    SimpleVisualizer() : window(nullptr), renderer(nullptr), running(false), backgroundIntensity(0.0f), barBeatBoost(0.0f), wavePhase(0.0f) {
         barHeights.resize(NUM_BARS, 0.0f);
         targetHeights.resize(NUM_BARS, 0.0f);
 
@@ -273,6 +231,22 @@ public:
         }
     }
 
+    void setPlasmaEngine(PlasmaEngine engine) {
+        plasmaRenderer.setEngine(engine);
+    }
+
+    void setCurveScriptPath(const std::string& path) {
+        curveScriptPath = path;
+    }
+
+    void setPointCloud(bool enable) {
+        pointCloudEnabled = enable;
+    }
+
+    void setCurveLayerCount(int layers) {
+        curveLayerCount = (std::max)(1, (std::min)(layers, MAX_CURVE_LAYERS));
+    }
+
     ~SimpleVisualizer() {
         cleanup();
     }
@@ -285,7 +259,7 @@ public:
 
        window = SDL_CreateWindow("Music Visualizer",
          SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
 
         /*
         window = SDL_CreateWindow("SynTheSia",
@@ -301,6 +275,8 @@ public:
 
 
         SDL_GetWindowSize(window, &SCREEN_WIDTH, &SCREEN_HEIGHT);
+        width = SCREEN_WIDTH;
+        height = SCREEN_HEIGHT;
 
  
 
@@ -318,13 +294,13 @@ public:
 
         SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
-        // Create texture for curve rendering
-        curveTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT);
-        if (!curveTexture) {
-            std::cerr << "Curve texture creation failed: " << SDL_GetError() << std::endl;
-            return false;
-        }
-        SDL_SetTextureBlendMode(curveTexture, SDL_BLENDMODE_BLEND);
+        // Procedural layers are rendered below screen size and stretched
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+
+        textures.setRenderer(renderer);
+
+        int scripts = loadCurveScripts(curveScriptPath);
+        std::cout << "Scripted curves: " << scripts << " from " << curveScriptPath << std::endl;
 
         if (!engine.initialize()) {
             std::cerr << "Audio engine init failed!" << std::endl;
@@ -337,586 +313,157 @@ public:
 
   
 
-    Vector2D calculateCurvePoint(float theta, float r, int type) {
-        if (type == -1) type = currentCurve;
-
-        
-
-        float n3 = 0.5f + noise(TIME_SLOWDOWN / 10.0f + type * 2.0f);
-        float tFactor = TIME_SLOWDOWN * (0.8f + 0.2f * noise(TIME_SLOWDOWN / 15.0f + type));
-
-        float phi = M_PI / 4.0f; // fixed elevation for 3D
-        Vector3D p3 = {
-            r * std::sinf(phi) * std::cosf(theta),
-            r * std::sinf(phi) * std::sinf(theta),
-            r * std::cosf(phi)
-        };
-
-        // Apply modulation to create visual variation
-        p3.x += 0.3f * r * std::cosf(theta * param1 + tFactor);
-        p3.y += 0.3f * r * std::sinf(theta * param2 - tFactor);
-
-
-        try {
-            //float n3 = 0.5f + noise(t / 10 + type * 2);
-            //float tFactor = t * (0.8f + 0.2f * noise(t / 15 + type));
-            //Vector2D defaultPos(r * std::cosf(theta), r * std::sinf(theta));
-           
-
-
-            switch (type % 99) {
-            case 0:
-                return Vector2D(r * std::cosf(param1 * theta) * std::cosf(theta * n3 + t),
-                    r * std::sinf(param2 * theta) * std::sinf(theta * 0.8f - t / 2));
-            case 1: {
-                float spiral = r * (0.6f + 0.3f * noise(theta / 8 + t));
-                return Vector2D(spiral * std::cosf(theta) + r / 5 * std::cosf(9 * theta + t * 1.3f),
-                    spiral * std::sinf(theta) - r / 5 * std::sinf(7 * theta - t * 1.1f));
-            }
-            case 2:
-                return Vector2D(r * std::sinf(theta * param1 + t * 1.3f) * std::cosf(theta * param2 - t / 2),
-                    r * std::cosf(theta * param2 - t * 1.7f) * std::sinf(theta * param1 + t / 3));
-            case 3:
-                return Vector2D(r * std::cosf(theta) * (1 + 0.25f * std::sinf(7 * theta + t * 3)),
-                    r * std::sinf(theta) * (1 + 0.25f * std::cosf(5 * theta - t * 2)));
-            case 4: {
-                float vortex = r * (0.3f + 0.5f * std::powf(std::sinf(theta / 2 + t), 2));
-                return Vector2D(vortex * std::cosf(theta + 5 * std::sinf(theta / 3 + t / 4)),
-                    vortex * std::sinf(theta + 5 * std::cosf(theta / 4 - t / 5)));
-            }
-            case 5:
-                return Vector2D(r * std::sinf(3 * theta + t * 1.2f) * std::cosf(2 * theta - t * 0.7f),
-                    r * std::cosf(4 * theta - t * 0.9f) * std::sinf(5 * theta + t * 1.1f));
-
-            case 6: {
-                float branch = r * (0.4f + 0.1f * noise(theta * 5 + t));
-                return Vector2D(branch * std::cosf(theta) * (1 + 0.3f * std::sinf(13 * theta + t * 2)),
-                    branch * std::sinf(theta) * (1 + 0.3f * std::cosf(11 * theta - t * 1.5f)));
-            }
-            case 7: {
-                float orbital = r * (0.7f + 0.2f * std::sinf(theta * 2 + t * 3));
-                return Vector2D(orbital * std::cosf(theta + std::sinf(theta * 7 + t * 2)),
-                    orbital * std::sinf(theta + std::cosf(theta * 6 - t * 1.8f)));
-            }
-            case 8:
-                return Vector2D(r * std::tanf(theta * param1 * 0.2f + t) * std::cosf(theta * param2 * 0.3f),
-                    r * std::tanf(theta * param2 * 0.25f - t) * std::sinf(theta * param1 * 0.35f));
-            case 9: {
-                float flux = r * (0.5f + 0.3f * std::atanf(std::sinf(theta * 3 + t)));
-                return Vector2D(flux * std::cosf(theta) + r / 4 * std::logf(std::fabs(5 * theta + t)),
-                    flux * std::sinf(theta) - r / 4 * std::logf(std::fabs(4 * theta - t)));
-            }
-            case 10:
-                return Vector2D(r * std::powf(std::sinf(theta * 0.7f + t), 3) * std::cosf(theta * 2),
-                    r * std::powf(std::cosf(theta * 0.8f - t), 3) * std::sinf(theta * 2.5f));
-            case 11: {
-                float bio = r * (0.4f + 0.2f * (std::expf(std::sinf(theta + t)) - 0.5f));
-                return Vector2D(bio * std::cosf(theta) * (1 + 0.4f * std::sinf(17 * theta + t * 4)),
-                    bio * std::sinf(theta) * (1 + 0.4f * std::cosf(19 * theta - t * 3)));
-            }
-            case 12: {
-                float well = r * (0.3f + 0.6f / (1 + 0.5f * std::fabs(theta - M_PI + t)));
-                return Vector2D(well * std::cosf(theta + t / 3), well * std::sinf(theta - t / 4));
-            }
-            case 13:
-                return Vector2D(r * std::sinf(theta + t) * std::cosf(2 * theta + t / 2) * (1 + 0.2f * std::sinf(23 * theta)),
-                    r * std::cosf(theta - t) * std::sinf(3 * theta - t / 3) * (1 + 0.2f * std::cosf(19 * theta)));
-            case 14:
-                return Vector2D(r * std::powf(std::cosf(theta * param1), 2) * std::cosf(3 * theta + tFactor),
-                    r * std::powf(std::sinf(theta * param2), 2) * std::sinf(2 * theta - tFactor));
-            case 15: {
-                float torus = r * (0.5f + 0.3f * std::sinf(theta * 4 + tFactor * 2));
-                return Vector2D(torus * std::cosf(theta) + r / 3 * std::sinf(theta * 7 + tFactor),
-                    torus * std::sinf(theta) - r / 3 * std::cosf(theta * 5 - tFactor));
-            }
-            case 16: {
-                float fib = r * (0.4f + 0.1f * std::fmodf(theta, TWO_PI) / M_PI);
-                return Vector2D(fib * std::cosf(theta + tFactor) * (1 + 0.2f * std::sinf(13 * theta)),
-                    fib * std::sinf(theta - tFactor) * (1 + 0.2f * std::cosf(11 * theta)));
-            }
-            case 17:
-                return Vector2D(r * (std::cosf(theta * param1) + 0.3f * noise(theta * 10 + tFactor)) * std::cosf(theta + t / 5),
-                    r * (std::sinf(theta * param2) + 0.3f * noise(theta * 12 - tFactor)) * std::sinf(theta - t / 7));
-            case 18: {
-                float nebula = r * (0.6f + 0.2f * std::powf(std::sinf(theta * 0.7f + tFactor * 0.3f), 3));
-                return Vector2D(nebula * std::cosf(theta) * (1 + 0.4f * std::tanf(theta * 3 + tFactor * 0.5f)),
-                    nebula * std::sinf(theta) * (1 + 0.4f * std::tanf(theta * 4 - tFactor * 0.6f)));
-            }
-            case 19:
-                return Vector2D(r * std::sinf(theta * param1) * std::cosf(theta * param2 + tFactor) * (1 + 0.2f * std::sinf(17 * theta)),
-                    r * std::cosf(theta * param2) * std::sinf(theta * param1 - tFactor) * (1 + 0.2f * std::cosf(19 * theta)));
-            case 20:
-                return Vector2D(r * std::tanf(theta * 0.3f + tFactor * 0.2f) * std::cosf(theta * 2),
-                    r * std::tanf(theta * 0.4f - tFactor * 0.3f) * std::sinf(theta * 1.5f));
-            case 21: {
-                float aurora = r * (0.7f + 0.1f * std::atanf(std::sinf(theta * 5 + tFactor * 2)));
-                return Vector2D(aurora * std::cosf(theta + std::sinf(theta * 9 + tFactor)),
-                    aurora * std::sinf(theta - std::cosf(theta * 8 - tFactor)));
-            }
-            case 22: {
-                float bloom = r * (0.4f + 0.3f * std::powf(std::sinf(theta * 0.5f + tFactor * 0.4f), 5));
-                return Vector2D(bloom * std::cosf(theta) * (1 + 0.5f * std::sinf(23 * theta + tFactor * 3)),
-                    bloom * std::sinf(theta) * (1 + 0.5f * std::cosf(21 * theta - tFactor * 2)));
-            }
-            case 23:
-                return Vector2D(r * std::asinf(std::sinf(theta + tFactor)) * std::cosf(3 * theta),
-                    r * std::acosf(std::cosf(theta - tFactor)) * std::sinf(2 * theta));
-            case 24: {
-                float star = r * (0.5f + 0.3f * std::sinf(theta * 5 + tFactor * 1.5f));
-                return Vector2D(star * std::cosf(theta) * (1 + 0.3f * std::sinf(8 * theta + tFactor * 2)),
-                    star * std::sinf(theta) * (1 + 0.3f * std::cosf(8 * theta - tFactor * 2)));
-            }
-            case 25: {
-                float a = r * 0.6f, b = r * 0.2f;
-                return Vector2D((a + b) * std::cosf(theta) - b * std::cosf((a / b + 1) * theta + tFactor),
-                    (a + b) * std::sinf(theta) - b * std::sinf((a / b + 1) * theta + tFactor));
-            }
-            case 26: {
-                float c = r * 0.7f, d = r * 0.175f;
-                return Vector2D((c - d) * std::cosf(theta) + d * std::cosf((c / d - 1) * theta - tFactor),
-                    (c - d) * std::sinf(theta) - d * std::sinf((c / d - 1) * theta - tFactor));
-            }
-            case 27:
-                return Vector2D(r * std::sinf(3 * theta + tFactor * 0.8f) * std::cosf(theta * param1),
-                    r * std::sinf(4 * theta - tFactor * 0.9f) * std::sinf(theta * param2));
-            case 28: {
-                float R = r * 0.6f, r2 = r * 0.3f;
-                return Vector2D((R + r2 * std::cosf(theta * 5 + tFactor)) * std::cosf(theta),
-                    (R + r2 * std::sinf(theta * 5 + tFactor)) * std::sinf(theta));
-            }
-            case 29: {
-                float cat = r * (std::coshf(theta * 0.5f + tFactor * 0.5f) - 1);
-                return Vector2D(cat * std::cosf(theta + tFactor * 0.3f),
-                    cat * std::sinf(theta - tFactor * 0.3f));
-            }
-            case 30:
-                return Vector2D(r * (std::cosf(theta + tFactor) + theta * std::sinf(theta + tFactor)),
-                    r * (std::sinf(theta + tFactor) - theta * std::cosf(theta + tFactor)));
-            case 31: {
-                float arch = r * (0.1f + 0.4f * (theta / TWO_PI + tFactor * 0.2f));
-                return Vector2D(arch * std::cosf(theta), arch * std::sinf(theta));
-            }
-            case 32: {
-                float card = r * (1 + std::cosf(theta + tFactor * 0.7f));
-                return Vector2D(card * std::cosf(theta), card * std::sinf(theta));
-            }
-            case 33: {
-                float lem = r * std::sqrtf(std::fabs(std::cosf(2 * theta + tFactor)));
-                return Vector2D(lem * std::cosf(theta) * (1 + 0.2f * std::sinf(6 * theta + tFactor)),
-                    lem * std::sinf(theta) * (1 + 0.2f * std::cosf(6 * theta - tFactor)));
-            }
-            case 34:
-                return Vector2D(r * (2 * std::cosf(theta + tFactor) + std::cosf(2 * theta + tFactor * 2)),
-                    r * (2 * std::sinf(theta + tFactor) - std::sinf(2 * theta + tFactor * 2)));
-            case 35:
-                return Vector2D(r * std::powf(std::cosf(theta + tFactor), 3),
-                    r * std::powf(std::sinf(theta + tFactor), 3));
-            case 36: {
-                float k = r * 0.5f;
-                return Vector2D(k * (3 * std::cosf(theta) - std::cosf(3 * theta + tFactor)),
-                    k * (3 * std::sinf(theta) - std::sinf(3 * theta + tFactor)));
-            }
-            case 37: {
-                float a1 = r * 0.7f, b1 = r * 0.5f;
-                return Vector2D((a1 * a1 - b1 * b1) * std::cosf(theta + tFactor) * std::cosf(theta) / a1,
-                    (a1 * a1 - b1 * b1) * std::sinf(theta + tFactor) * std::sinf(theta) / b1);
-            }
-            case 38: {
-                float k1 = 0.1f + 0.05f * noise(tFactor);
-                return Vector2D(r * std::expf(k1 * theta) * std::cosf(theta + tFactor * 0.5f),
-                    r * std::expf(k1 * theta) * std::sinf(theta + tFactor * 0.5f));
-            }
-            case 39: {
-                float s = theta * 0.5f + tFactor;
-                return Vector2D(r * 0.5f * std::cosf(s * s) * (1 + 0.2f * std::sinf(5 * theta + tFactor)),
-                    r * 0.5f * std::sinf(s * s) * (1 + 0.2f * std::cosf(5 * theta + tFactor)));
-            }
-            case 40: {
-                float tr = r * (1 + 0.2f * noise(theta + tFactor));
-                return Vector2D(tr * (std::cosf(theta) + std::logf(std::tanf(theta / 2 + tFactor * 0.1f))),
-                    tr * std::sinf(theta));
-            }
-            case 41: {
-                float cis = r * std::sinf(theta) * std::sinf(theta + tFactor);
-                return Vector2D(cis * std::cosf(theta) / (1 - std::sinf(theta + tFactor)),
-                    cis * std::sinf(theta) / (1 - std::sinf(theta + tFactor)));
-            }
-            case 42: {
-                float n = std::floor(param1 + 0.5f);
-                return Vector2D(r * std::cosf(n * theta + tFactor) * std::cosf(theta),
-                    r * std::cosf(n * theta + tFactor) * std::sinf(theta));
-            }
-            case 43: {
-                float theo = r * std::sqrtf(theta / M_PI + tFactor * 0.3f);
-                return Vector2D(theo * std::cosf(theta), theo * std::sinf(theta));
-            }
-            case 44: {
-                float a2 = r * 0.5f, b2 = r * 0.7f;
-                return Vector2D(a2 * std::cosf(theta) + b2 * std::cosf(theta + tFactor) / std::cosf(theta),
-                    a2 * std::sinf(theta) + b2 * std::sinf(theta + tFactor) / std::cosf(theta));
-            }
-            case 45: {
-                float a3 = r * 0.5f;
-                return Vector2D(a3 * (std::cosf(theta) - std::cosf(2 * theta + tFactor)) / std::sinf(theta),
-                    a3 * (std::cosf(theta) + std::cosf(2 * theta + tFactor)) * std::sinf(theta));
-            }
-            case 46: {
-                float a4 = r * 0.6f, b4 = r * 0.4f;
-                return Vector2D((a4 + b4 * std::cosf(theta + tFactor)) * std::cosf(theta),
-                    (a4 + b4 * std::cosf(theta + tFactor)) * std::sinf(theta));
-            }
-            case 47: {
-                float a5 = r * 0.5f;
-                return Vector2D(a5 * (1 / std::cosf(theta) + std::cosf(theta + tFactor)) * std::cosf(theta),
-                    a5 * (1 / std::cosf(theta) + std::cosf(theta + tFactor)) * std::sinf(theta));
-            }
-            case 48: {
-                float a6 = r * 0.7f;
-                return Vector2D(a6 * std::cosf(theta) / (1 + std::sinf(theta + tFactor)),
-                    a6 * std::cosf(theta) * std::sinf(theta + tFactor) / (1 + std::sinf(theta + tFactor)));
-            }
-            case 49: {
-                float a7 = r * 0.6f, b7 = r * 0.3f;
-                return Vector2D(a7 * (1 + std::sinf(theta + tFactor)) * std::cosf(theta),
-                    b7 * (1 + std::sinf(theta + tFactor)) * std::sinf(theta));
-            }
-            case 50: {
-                float a8 = r * 0.5f;
-                return Vector2D(a8 * (std::powf(theta, 2) * std::cosf(theta + tFactor) - theta * std::sinf(theta)),
-                    a8 * (std::powf(theta, 2) * std::sinf(theta + tFactor) + theta * std::cosf(theta)));
-            }
-            case 51: {
-                float a9 = r * 0.5f, c9 = r * 0.7f;
-                float rho = std::sqrtf(std::powf(a9 * std::cosf(2 * theta + tFactor), 2) + c9 * c9);
-                return Vector2D(rho * std::cosf(theta), rho * std::sinf(theta));
-            }
-            case 52: {
-                float a10 = r * 0.6f, b10 = r * 0.4f;
-                float m = std::sqrtf(a10 * a10 - b10 * b10 * std::sinf(theta + tFactor) * std::sinf(theta + tFactor));
-                return Vector2D(m * std::cosf(theta), b10 * std::sinf(theta + tFactor));
-            }
-            case 53: {
-                float a11 = r * 0.5f;
-                return Vector2D(a11 * theta * std::sinhf(theta + tFactor * 0.3f),
-                    a11 * (std::coshf(theta + tFactor * 0.3f) - 1));
-            }
-            case 54: {
-                float a12 = r * 0.6f;
-                return Vector2D(a12 * std::sinf(theta + tFactor) * std::cosf(2 * theta + tFactor * 0.5f),
-                    a12 * std::cosf(theta + tFactor) * std::sinf(2 * theta + tFactor * 0.5f));
-            }
-            case 55: {
-                float a13 = r * 0.5f;
-                return Vector2D(a13 * 3 * std::cosf(theta) / (1 + std::powf(std::sinf(theta + tFactor), 3)),
-                    a13 * 3 * std::cosf(theta) * std::sinf(theta + tFactor) / (1 + std::powf(std::sinf(theta + tFactor), 3)));
-            }
-            case 56: {
-                float a14 = r * 0.6f;
-                return Vector2D(a14 * (2 * std::cosf(theta + tFactor) + 1) * std::cosf(theta),
-                    a14 * (2 * std::cosf(theta + tFactor) + 1) * std::sinf(theta));
-            }
-            case 57: {
-                float a15 = r * 0.5f;
-                return Vector2D(a15 * std::cosf(theta) * (std::cosf(theta) - std::sinf(theta + tFactor)) / std::sinf(theta),
-                    a15 * std::cosf(theta) * (std::cosf(theta) + std::sinf(theta + tFactor)));
-            }
-            case 58: {
-                float a16 = r * 0.5f;
-                return Vector2D(a16 * std::powf(theta, 2) * std::cosf(theta + tFactor),
-                    a16 * std::powf(theta, 3) * std::sinf(theta + tFactor));
-            }
-            case 59: {
-                float a17 = r * 0.5f;
-                return Vector2D(a17 * (3 * std::cosf(theta) - std::cosf(3 * theta + tFactor)),
-                    a17 * 3 * std::sinf(theta) * std::cosf(theta + tFactor) * std::cosf(theta + tFactor));
-            }
-            case 60: {
-                float a18 = r * 0.6f, b18 = r * 0.3f;
-                return Vector2D(a18 * std::cosf(theta) + b18 * std::sinf(theta + tFactor) / std::cosf(theta),
-                    a18 * std::sinf(theta) + b18 * std::cosf(theta + tFactor) / std::cosf(theta));
-            }
-            case 61: {
-                float a19 = r * 0.5f;
-                return Vector2D(a19 * std::cosf(theta) / (1 + std::powf(std::sinf(theta + tFactor), 2)),
-                    a19 * std::cosf(theta) * std::sinf(theta + tFactor) / (1 + std::powf(std::sinf(theta + tFactor), 2)));
-            }
-            case 62: {
-                float a20 = r * 0.5f;
-                return Vector2D(a20 * (theta - std::sinf(theta + tFactor)),
-                    a20 * (1 - std::cosf(theta + tFactor)));
-            }
-            case 63: {
-                float a21 = r * 0.6f, b21 = r * 0.4f;
-                float rho2 = std::sqrtf((std::powf(a21 * std::sinf(theta + tFactor), 2) - std::powf(b21 * std::cosf(theta), 2)) / (1 - 0.5f * std::sinf(theta + tFactor) * std::sinf(theta + tFactor)));
-                return Vector2D(rho2 * std::cosf(theta), rho2 * std::sinf(theta));
-            }
-            case 64: {
-                float a22 = r * 0.5f, n22 = std::floor(param1 + 0.5f);
-                return Vector2D(a22 * std::powf(std::fabs(std::cosf(theta + tFactor)), 1.0f / n22) * std::cosf(theta),
-                    a22 * std::powf(std::fabs(std::sinf(theta + tFactor)), 1.0f / n22) * std::sinf(theta));
-            }
-            case 65: {
-                float a23 = r * 0.5f;
-                return Vector2D(a23 * 2 * std::cosf(theta) * (1 + 0.2f * std::sinf(5 * theta + tFactor)),
-                    a23 * 2 / (1 + std::powf(std::tanf(theta + tFactor), 2)));
-            }
-            case 66: {
-                float a24 = r * 0.5f;
-                return Vector2D(a24 * (theta + std::sinhf(theta + tFactor) * std::cosf(theta)),
-                    a24 * (std::coshf(theta + tFactor) - std::sinf(theta)));
-            }
-            case 67: {
-                float a25 = r * 0.6f;
-                return Vector2D(a25 * (3 * std::cosf(theta + tFactor) - 1) * std::cosf(theta),
-                    a25 * (3 * std::cosf(theta + tFactor) - 1) * std::sinf(theta));
-            }
-            case 68: {
-                float a26 = r * 0.5f;
-                return Vector2D(a26 * std::sqrtf(1 / (theta + tFactor + 0.1f)) * std::cosf(theta),
-                    a26 * std::sqrtf(1 / (theta + tFactor + 0.1f)) * std::sinf(theta));
-            }
-            case 69: {
-                float a27 = r * 0.5f;
-                return Vector2D(a27 * 2 * std::sinf(theta) * std::cosf(theta + tFactor) / (1 + std::powf(std::cosf(theta + tFactor), 2)),
-                    a27 * 2 * std::sinf(theta) * std::sinf(theta + tFactor) / (1 + std::powf(std::cosf(theta + tFactor), 2)));
-            }
-            case 70: {
-                float a28 = r * 0.5f;
-                return Vector2D(a28 * std::cosf(theta) * (1 + 0.3f * noise(theta / 5 + tFactor)),
-                    a28 / (1 + std::powf(theta + tFactor, 2)));
-            }
-            case 71: {
-                float a29 = r * 0.6f, b29 = r * 0.2f, d29 = r * 0.3f;
-                return Vector2D((a29 + b29) * std::cosf(theta) - d29 * std::cosf((a29 / b29 + 1) * theta + tFactor),
-                    (a29 + b29) * std::sinf(theta) - d29 * std::sinf((a29 / b29 + 1) * theta + tFactor));
-            }
-            case 72: {
-                float a30 = r * 0.7f, b30 = r * 0.2f, d30 = r * 0.25f;
-                return Vector2D((a30 - b30) * std::cosf(theta) + d30 * std::cosf((a30 / b30 - 1) * theta - tFactor),
-                    (a30 - b30) * std::sinf(theta) - d30 * std::sinf((a30 / b30 - 1) * theta - tFactor));
-            }
-            case 74: {
-                float a32 = r * 0.5f;
-                return Vector2D(a32 * std::sinf(theta + tFactor) / (1 + std::powf(std::cosf(theta), 2)),
-                    a32 * std::sinf(theta) * std::cosf(theta + tFactor) / (1 + std::powf(std::cosf(theta), 2)));
-            }
-            case 75: {
-                float a33 = r * 0.5f, b33 = r * 0.6f;
-                return Vector2D(a33 * std::cosf(theta) + b33 * std::sinf(theta + tFactor) * std::cosf(theta),
-                    a33 * std::sinf(theta) + b33 * std::sinf(theta + tFactor) * std::sinf(theta));
-            }
-            case 76: {
-                float a34 = r * 0.5f;
-                return Vector2D(a34 * (3 * std::cosf(theta) + std::cosf(3 * theta + tFactor)),
-                    a34 * (3 * std::sinf(theta) + std::sinf(3 * theta + tFactor)));
-            }
-            case 77: {
-                float a35 = r * 0.5f;
-                return Vector2D(a35 * std::cosf(theta / 3 + tFactor) * std::cosf(theta) * std::cosf(theta),
-                    a35 * std::cosf(theta / 3 + tFactor) * std::sinf(theta) * std::cosf(theta));
-            }
-            case 78: {
-                float a36 = r * 0.5f;
-                return Vector2D(a36 * (1 / (theta + tFactor + 0.1f)) * std::cosf(theta),
-                    a36 * (1 / (theta + tFactor + 0.1f)) * std::sinf(theta));
-            }
-            case 79: {
-                float a37 = r * 0.5f;
-                return Vector2D(a37 * std::cosf(theta) / std::cosf(theta + tFactor),
-                    a37 * std::tanf(theta + tFactor) * std::sinf(theta));
-            }
-            case 80: {
-                float a38 = r * 0.5f;
-                return Vector2D(a38 * std::cosf(theta) * (1 + std::sinf(4 * theta + tFactor)),
-                    a38 * std::sinf(theta) * (1 + std::sinf(4 * theta + tFactor)));
-            }
-            case 81: {
-                float a39 = r * 0.6f, b39 = r * 0.3f;
-                float m2 = std::sqrtf(a39 * a39 + b39 * b39 * std::cosf(theta + tFactor) * std::cosf(theta + tFactor));
-                return Vector2D(m2 * std::cosf(theta), b39 * std::cosf(theta + tFactor));
-            }
-            case 82: {
-                float a40 = r * 0.7f, b40 = r * 0.5f;
-                return Vector2D(a40 * std::cosf(theta) * (1 + 0.2f * std::sinf(5 * theta + tFactor)),
-                    b40 * std::sinf(theta) * (1 + 0.2f * std::cosf(5 * theta + tFactor)));
-            }
-            case 83: {
-                float a41 = r * 0.5f;
-                return Vector2D(a41 * std::sinf(theta) * (std::expf(std::cosf(theta + tFactor)) - 2 * std::cosf(4 * theta) - std::powf(std::sinf(theta / 12), 5)),
-                    a41 * std::cosf(theta) * (std::expf(std::cosf(theta + tFactor)) - 2 * std::cosf(4 * theta) - std::powf(std::sinf(theta / 12), 5)));
-            }
-            case 84: {
-                float a42 = r * 0.5f;
-                return Vector2D(a42 * (2 * std::cosf(theta + tFactor) + std::cosf(2 * theta + tFactor)),
-                    a42 * (2 * std::sinf(theta + tFactor) - std::sinf(2 * theta + tFactor)));
-            }
-            case 85: {
-                float a43 = r * 0.5f;
-                return Vector2D(a43 * std::sinf(theta + tFactor) / (theta + tFactor + 0.1f),
-                    a43 * std::cosf(theta) / (theta + tFactor + 0.1f));
-            }
-            case 86: {
-                float a44 = r * 0.5f;
-                return Vector2D(a44 * (theta / M_PI) * std::sinf(theta + tFactor),
-                    a44 * std::cosf(theta) / (theta / M_PI + tFactor + 0.1f));
-            }
-            case 87: {
-                float a45 = r * 0.5f, n45 = std::floor(param2 + 0.5f);
-                return Vector2D(a45 * std::powf(std::fabs(std::cosf(theta + tFactor)), 2.0f / n45) * std::cosf(theta),
-                    a45 * std::powf(std::fabs(std::sinf(theta + tFactor)), 2.0f / n45) * std::sinf(theta));
-            }
-            case 88:
-                return Vector2D(r * std::sinf(5 * theta + tFactor * 0.7f) * std::cosf(theta * param1),
-                    r * std::sinf(6 * theta - tFactor * 0.8f) * std::sinf(theta * param2));
-            case 89: {
-                float a46 = r * 0.5f, n46 = std::floor(param1 + 0.5f);
-                float k46 = n46 * theta + tFactor;
-                return Vector2D(a46 * std::sinf(n46 * k46) * std::cosf(k46),
-                    a46 * std::sinf(n46 * k46) * std::sinf(k46));
-            }
-            case 90: {
-                float s2 = theta * 0.4f + tFactor;
-                return Vector2D(r * 0.4f * std::cosf(s2 * s2 + tFactor) * (1 + 0.3f * std::sinf(6 * theta)),
-                    r * 0.4f * std::sinf(s2 * s2 + tFactor) * (1 + 0.3f * std::cosf(6 * theta)));
-            }
-            case 91: {
-                float a47 = r * 0.5f;
-                return Vector2D(a47 * (theta - std::sinf(theta + tFactor) + 0.2f * std::sinf(5 * theta)),
-                    a47 * (1 - std::cosf(theta + tFactor) + 0.2f * std::cosf(5 * theta)));
-            }
-            case 92: {
-                float a48 = r * 0.5f;
-                return Vector2D(a48 * (1 + std::sinf(theta + tFactor)) * std::cosf(theta),
-                    a48 * (1 + std::sinf(theta + tFactor)) * std::sinf(theta));
-            }
-            case 93: {
-                float a49 = r * 0.5f;
-                return Vector2D(a49 * std::powf(std::cosf(theta + tFactor), 5) * std::cosf(theta),
-                    a49 * std::powf(std::sinf(theta + tFactor), 5) * std::sinf(theta));
-            }
-            case 94: {
-                float a50 = r * 0.5f;
-                return Vector2D(a50 * (2 * std::cosf(theta + tFactor) - std::cosf(2 * theta + tFactor * 1.5f)),
-                    a50 * (2 * std::sinf(theta + tFactor) + std::sinf(2 * theta + tFactor * 1.5f)));
-            }
-            case 95: {
-                float a51 = r * 0.5f;
-                return Vector2D(a51 * (3 * std::cosf(theta) - std::cosf(5 * theta + tFactor)),
-                    a51 * (3 * std::sinf(theta) - std::sinf(5 * theta + tFactor)));
-            }
-            case 96: {
-                float a52 = r * 0.6f, b52 = r * 0.4f;
-                return Vector2D(a52 * (1 + std::cosf(theta + tFactor)) * std::cosf(theta),
-                    b52 * (1 + std::cosf(theta + tFactor)) * std::sinf(theta));
-            }
-            case 97: {
-                float a53 = r * 0.5f;
-                return Vector2D(a53 * 3 * std::sinf(theta) * std::cosf(theta + tFactor) / (1 + std::sinf(theta + tFactor)),
-                    a53 * 3 * std::sinf(theta) * std::sinf(theta + tFactor) / (1 + std::sinf(theta + tFactor)));
-            }
-            case 98: {
-                float a54 = r * 0.5f;
-                return Vector2D(a54 * (std::cosf(theta) + std::logf(std::tanf(theta / 2 + tFactor * 0.2f))),
-                    a54 * std::sinf(theta) * (1 + 0.2f * std::sinf(5 * theta + tFactor)));
-            }
-            case 99: {
-                float a55 = r * 0.5f, b55 = r * 0.6f;
-                return Vector2D(a55 * std::cosf(theta) + b55 * std::sinf(theta + tFactor) / std::cosf(theta + tFactor),
-                    a55 * std::sinf(theta) + b55 * std::sinf(theta + tFactor) * std::sinf(theta));
-            }
-
-            default:
-               // return Vector2D(r * std::cosf(theta), r * std::sinf(theta));
-                return Vector2D(p3.x, p3.y);
-            }
-        }
-        catch (...) {
-            return Vector2D(r * std::cosf(theta), r * std::sinf(theta));
+    float bandLevel(CurveBand band) const {
+        switch (band) {
+        case CurveBand::Bass: return audioParams.smoothedBass;
+        case CurveBand::Treble: return audioParams.smoothedTreble;
+        case CurveBand::Amplitude: return audioParams.smoothedAmplitude;
+        default: return audioParams.smoothedMid;
         }
     }
 
-
-   
-    void drawCurveType(SDL_Texture* texture, int type, float weight) {
-        int resolution = PAR;
+    // Works out everything the compositor needs to draw one layer
+    void resolveCurveLayer(const CurveLayer& layer, bool primary, CurveLayerFrame& frame) {
+        int type = layer.type;
+        float weight = layer.weight;
         bool hasRealAudio = !engine.isSimulationMode();
          
 
         float audioSizeBoost = hasRealAudio ?
             (1.0f + audioParams.smoothedBass * 0.7f + audioParams.beatIntensity * 0.6f) : 1.0f;
 
-        float size = ((std::max)(width, height) * 0.5f + minRadius) * baseScale * audioSizeBoost;
+        float size = ((std::max)(width, height) * 0.5f + minRadius) * baseScale * audioSizeBoost * layer.scale;
 
         auto& palette = colorPalettes;
-        std::vector<SDL_Point> points;
-        points.reserve(resolution + 1);
-
-        float rotationSpeed = hasRealAudio ?
-            (audioParams.rotationSpeed * (1.0f + audioParams.beatIntensity * 0.8f)) : 1.0f;
-
-        float tSlow = t * TIME_SLOWDOWN;
-        float rotation = tSlow * 0.1f * ((type % 2) ? 0.5 : -0.5) * rotationSpeed;
-        float sinWaveMod = std::sinf(tSlow * 0.5f + type) * 0.3f + 1.0f;
-
-        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderTarget(renderer, texture);
-        SDL_SetRenderDrawColor(renderer, 244, 0, 0, 0);
-        SDL_RenderClear(renderer);
-
-        
-
-        for (int i = 0; i <= resolution; i++) {
-            float theta = i * (TWO_PI * 4) / resolution;
 
-            float audioMod = hasRealAudio ?
-                (1.0f + audioParams.smoothedMid * 0.3f * sinWaveMod) : 1.0f;
+        float rotationSpeed = (hasRealAudio ?
+            (audioParams.rotationSpeed * (1.0f + audioParams.beatIntensity * 0.8f)) : 1.0f) * layer.rotationSpeed;
 
-            Vector2D point = calculateCurvePoint(theta, size * audioMod, type);
+        // Mid-morph the per-type terms blend along with the shape
+        bool morphing = primary && curveMorph.isActive();
+        float morphWeight = morphing ? curveMorph.getWeight() : 1.0f;
+        int fromType = morphing ? curveMorph.getFromType() : type;
+        float fromDirection = (fromType % 2) ? 0.5f : -0.5f;
+        float toDirection = (type % 2) ? 0.5f : -0.5f;
 
-            float rPoint = std::sqrtf(point.x * point.x + point.y * point.y);
-            if (rPoint < minRadius * baseScale) {
-                float scaleFactor = (minRadius * baseScale) / (rPoint + 0.01f);
-                point.x *= scaleFactor;
-                point.y *= scaleFactor;
-            }
-
-            float audioColorShift = hasRealAudio ?
-                (audioParams.smoothedTreble * 30.0f + audioParams.beatIntensity * 50.0f) : 0.0f;
+        float tSlow = t * TIME_SLOWDOWN;
+        float rotation = tSlow * 0.1f * (fromDirection + (toDirection - fromDirection) * morphWeight) * rotationSpeed;
+        float sinWaveMod = std::sinf(tSlow * 0.5f + fromType + (type - fromType) * morphWeight) * 0.3f + 1.0f;
+
+        // Everything below is the same for every point of the curve
+        float audioMod = hasRealAudio ?
+            (1.0f + bandLevel(layer.band) * 0.3f * sinWaveMod) : 1.0f;
+        frame.kernel = curveKernel(type);
+        frame.params = makeCurveParams(type, size * audioMod, t, TIME_SLOWDOWN, param1, param2);
+        frame.params.bass = audioParams.smoothedBass;
+        frame.params.mid = audioParams.smoothedMid;
+        frame.params.treble = audioParams.smoothedTreble;
+        frame.params.amplitude = audioParams.smoothedAmplitude;
+        frame.params.beat = audioParams.beatIntensity;
+        frame.morph = morphing ? &curveMorph : nullptr;
+        frame.morphScale = size * audioMod;
+        frame.thetaEnd = TWO_PI * 4;
+        frame.rotation = rotation;
+        frame.centerX = width / 2;
+        frame.centerY = height / 2;
+        frame.minDistance = minRadius * baseScale;
+
+        float audioColorShift = hasRealAudio ?
+            (audioParams.smoothedTreble * 30.0f + audioParams.beatIntensity * 50.0f + audioParams.hatPulse * 40.0f) : 0.0f;
+        float saturation = 85.0f + (hasRealAudio ? audioParams.smoothedAmplitude * 10.0f : 0.0f);
+        float brightness = 95.0f + (hasRealAudio ? audioParams.beatIntensity * 10.0f : 0.0f);
+        float alpha = 255;
+
+        float hue = std::fmodf(palette[1] + t * 5.0f + layer.hueOffset, 360.0f);
+        frame.glowColor = hsbToRgb(hue, 70.0f, 100.0f, 0.3f * weight);
+        frame.glowWidth = 2.5f;
+
+        hue = std::fmodf(palette[0] + t * 10.0f + layer.hueOffset, 360.0f);
+        frame.lineColor = hsbToRgb(hue, 85.0f, 100.0f, 0.6f * weight);
+        frame.lineWidth = 0.6f;
+
+        // Markers stay where every 40th of the 120 uniform points used to be
+        frame.markerCount = 4;
+        frame.markerRadius = 2.0f;
+        for (int m = 0; m < frame.markerCount; m++) {
+            hue = std::fmodf(palette[(m * 40) % 3] + audioColorShift + layer.hueOffset, 360);
+            frame.markerColors[m] = hsbToRgb(hue, saturation, brightness, alpha);
+        }
+    }
 
-            float hue = std::fmodf(palette[i % 3] + audioColorShift, 360);
-            float saturation = 85.0f + (hasRealAudio ? audioParams.smoothedAmplitude * 10.0f : 0.0f);
-            float brightness = 95.0f + (hasRealAudio ? audioParams.beatIntensity * 10.0f : 0.0f);
-            float alpha = weight * 0.6f * (hasRealAudio ? audioParams.globalAmplification : 1.0f);
-             alpha = 255;
+    void drawCurves() {
+        curveLayers[0].type = currentCurve;
 
-            float x_rot = point.x * std::cosf(rotation) - point.y * std::sinf(rotation);
-            float y_rot = point.x * std::sinf(rotation) + point.y * std::cosf(rotation);
-            points.push_back({ static_cast<int>(x_rot + width / 2), static_cast<int>(y_rot + height / 2) });
+        // Layer 0 last, on top of the others
+        curveFrames.resize(curveLayerCount);
+        for (int i = 0; i < curveLayerCount; i++) {
+            resolveCurveLayer(curveLayers[curveLayerCount - 1 - i], i == curveLayerCount - 1, curveFrames[i]);
+        }
+        curveCompositor.compose(workerPool, curveFrames);
+        curveCompositor.draw(renderer);
+    }
 
-            if (i % 40 == 0) {
-                SDL_Color pointColor = hsbToRgb(hue, saturation, brightness, alpha);
-                filledCircleRGBA(renderer, points.back().x, points.back().y,
-                    2, pointColor.r, pointColor.g, pointColor.b, pointColor.a);
+    // The current curve as a tunnel of slices, each the shape a little
+    // further back in time, with the particles floating through the middle.
+    // The camera turns a step on every kick, eased over the beat.
+    void drawPointCloud() {
+        if (static_cast<int>(cloudTheta.size()) != CLOUD_SLICE_POINTS) {
+            cloudTheta.resize(CLOUD_SLICE_POINTS);
+            for (int i = 0; i < CLOUD_SLICE_POINTS; i++) {
+                cloudTheta[i] = TWO_PI * 4 * i / CLOUD_SLICE_POINTS;
             }
         }
 
-        if (!points.empty()) {
-            float hue = std::fmodf(palette[0] + t * 10.0f, 360.0f);
-            SDL_Color lineColor = hsbToRgb(hue, 85.0f, 100.0f, 0.6f * weight);
-            SDL_SetRenderDrawColor(renderer, lineColor.r, lineColor.g, lineColor.b, lineColor.a);
-            SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
-
-            hue = std::fmodf(palette[1] + t * 5.0f, 360.0f);
-            SDL_Color glowColor = hsbToRgb(hue, 70.0f, 100.0f, 0.15f * weight);
-            SDL_SetRenderDrawColor(renderer, glowColor.r, glowColor.g, glowColor.b, glowColor.a);
-            for (int i = -1; i <= 1; i += 2) {
-                std::vector<SDL_Point> shifted = points;
-                for (auto& p : shifted) { p.x += i; }
-                SDL_RenderDrawLines(renderer, shifted.data(), static_cast<int>(shifted.size()));
-            }
+        pointCloud.clear();
+        const int first = pointCloud.allocate(CLOUD_SLICES * CLOUD_SLICE_POINTS);
+        CurveBatchKernel kernel = curveKernel(currentCurve);
+        CurveParams base = makeCurveParams(currentCurve, 1.0f, t, TIME_SLOWDOWN, param1, param2);
+        base.bass = audioParams.smoothedBass;
+        base.mid = audioParams.smoothedMid;
+        base.treble = audioParams.smoothedTreble;
+        base.amplitude = audioParams.smoothedAmplitude;
+        base.beat = audioParams.beatIntensity;
+        const float hue = colorPalettes[2] + t * 10.0f;
+        workerPool.parallelFor(CLOUD_SLICES, [&](int slice) {
+            const int offset = first + slice * CLOUD_SLICE_POINTS;
+            float* x = pointCloud.getX() + offset;
+            float* y = pointCloud.getY() + offset;
+            float* z = pointCloud.getZ() + offset;
+            SDL_Color* colors = pointCloud.getColors() + offset;
+
+            CurveParams params = base;
+            params.t = t - slice * 0.04f;
+            kernel(params, cloudTheta.data(), x, y, CLOUD_SLICE_POINTS);
+            sanitizeCurvePoints(x, y, CLOUD_SLICE_POINTS, 2.0f);
+            const float depth = 2.0f * slice / (CLOUD_SLICES - 1) - 1.0f;
+            const SDL_Color color = hsbToRgb(hue + slice * 3.0f, 80.0f, 100.0f, 0.5f);
+            for (int i = 0; i < CLOUD_SLICE_POINTS; i++) {
+                z[i] = depth;
+                colors[i] = color;
+            }
+        });
+
+        // Particles drift backward as they fade
+        const int particleFirst = pointCloud.allocate(particles.size());
+        const float particleScale = 2.0f / (std::max)(SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (int i = 0; i < particles.size(); i++) {
+            pointCloud.getX()[particleFirst + i] = (particles.getX()[i] - SCREEN_WIDTH / 2) * particleScale;
+            pointCloud.getY()[particleFirst + i] = (particles.getY()[i] - SCREEN_HEIGHT / 2) * particleScale;
+            pointCloud.getZ()[particleFirst + i] = 0.5f - particles.getLife()[i] / particles.getStyles()[i].maxLife;
+            pointCloud.getColors()[particleFirst + i] = particles.getColor(i);
         }
 
-        SDL_SetRenderTarget(renderer, nullptr);
+        float phase = clamp((t - lastKickTime) / kickInterval, 0.0f, 1.0f);
+        float eased = phase * phase * (3.0f - 2.0f * phase);
+        float yaw = t * 0.1f + (static_cast<float>(cloudBeats) - 1.0f + eased) * CLOUD_BEAT_TURN;
+        float pitch = 0.35f * std::sin(t * 0.2f) + audioParams.beatIntensity * 0.15f;
+
+        const float focal = (std::max)(width, height) * 0.45f * CLOUD_DISTANCE;
+        Matrix4 camera = Matrix4::perspective(focal, width / 2.0f, height / 2.0f) *
+            Matrix4::translation(Vector3D{ 0.0f, 0.0f, CLOUD_DISTANCE }) *
+            Matrix4::rotationX(pitch) * Matrix4::rotationY(yaw);
+        pointCloud.render(workerPool, camera, width, height, 1.5f * CLOUD_DISTANCE, 0.1f, CLOUD_DISTANCE + 2.0f, 0.2f);
+        pointCloud.draw(renderer);
     }
 
 
@@ -927,6 +474,7 @@ public:
         Uint32 lastTime = SDL_GetTicks();
 
         while (running) {
+            Uint64 frameStart = SDL_GetPerformanceCounter();
             Uint32 currentTime = SDL_GetTicks();
             float deltaTime = (currentTime - lastTime) / 1000.0f;
             lastTime = currentTime;
@@ -936,6 +484,14 @@ public:
                 if (e.type == SDL_QUIT) {
                     running = false;
                 }
+                else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    // Layers pick up the new size with their next acquire
+                    SCREEN_WIDTH = e.window.data1;
+                    SCREEN_HEIGHT = e.window.data2;
+                    // The curve layers and the point cloud center on these
+                    width = SCREEN_WIDTH;
+                    height = SCREEN_HEIGHT;
+                }
                 else if (e.type == SDL_KEYDOWN) {
                     if (e.key.keysym.sym == SDLK_ESCAPE) {
                         running = false;
@@ -944,7 +500,63 @@ public:
                         printDebugInfo();
                     }
                     else if (e.key.keysym.sym == SDLK_c) {
-                        currentCurve = (currentCurve + 1) % 6; // Cycle through curve types
+                        // Cycle through curve types
+                        requestCurve(curveAt((curveIndex(pendingCurve >= 0 ? pendingCurve : currentCurve) + 1) % curvePlaylistSize()));
+                    }
+                    else if (e.key.keysym.sym == SDLK_i) {
+                        // Cycle plasma interlacing: every row, 1/2, 1/3, 1/4 per frame
+                        plasmaRenderer.setInterlace(plasmaRenderer.getInterlace() % 4 + 1);
+                        std::cout << "Plasma interlace 1/" << plasmaRenderer.getInterlace() << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_k) {
+                        // Cycle the plasma kaleidoscope: off, 2, 4, 6, 8 folds
+                        int folds = plasmaRenderer.getKaleidoscope();
+                        plasmaRenderer.setKaleidoscope(folds == 0 ? 2 : folds + 2);
+                        if (plasmaRenderer.getKaleidoscope() > 0) {
+                            std::cout << "Plasma kaleidoscope " << plasmaRenderer.getKaleidoscope() << "-fold" << std::endl;
+                        }
+                        else {
+                            std::cout << "Plasma kaleidoscope off" << std::endl;
+                        }
+                    }
+                    else if (e.key.keysym.sym == SDLK_p) {
+                        // Cycle the plasma engines: field, palette cycle, fixed point
+                        plasmaRenderer.setEngine(static_cast<PlasmaEngine>((static_cast<int>(plasmaRenderer.getEngine()) + 1) % 3));
+                        std::cout << "Plasma engine: " << PlasmaRenderer::engineName(plasmaRenderer.getEngine()) << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_b) {
+                        plasmaBeatRefresh = !plasmaBeatRefresh;
+                        std::cout << "Plasma beat refresh " << (plasmaBeatRefresh ? "on" : "off") << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_t) {
+                        // Cycle the curve tolerance: 0.5, 1, 2 px
+                        float tolerance = curveCompositor.getTolerance();
+                        curveCompositor.setTolerance(tolerance >= 2.0f ? 0.5f : tolerance * 2.0f);
+                        std::cout << "Curve tolerance " << curveCompositor.getTolerance() << " px" << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_l) {
+                        setCurveLayerCount(curveLayerCount % MAX_CURVE_LAYERS + 1);
+                        std::cout << "Curve layers: " << curveLayerCount << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_a) {
+                        curveMorph.setArcLength(!curveMorph.getArcLength());
+                        std::cout << "Curve morph by " << (curveMorph.getArcLength() ? "arc length" : "angle") << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_u) {
+                        // Reload the scripted curves; types of scripts that are gone fall back to 0
+                        int scripts = loadCurveScripts(curveScriptPath);
+                        curveMorph.clearCache();
+                        if (currentCurve >= kCurveTypeCount + scripts) currentCurve = 0;
+                        if (pendingCurve >= kCurveTypeCount + scripts) pendingCurve = -1;
+                        std::cout << "Scripted curves: " << scripts << " from " << curveScriptPath << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_3) {
+                        pointCloudEnabled = !pointCloudEnabled;
+                        std::cout << "Point cloud " << (pointCloudEnabled ? "on" : "off") << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_r) {
+                        resolution.setEnabled(!resolution.isEnabled());
+                        std::cout << "Dynamic resolution " << (resolution.isEnabled() ? "on" : "off") << std::endl;
                     }
                 }
             }
@@ -953,7 +565,14 @@ public:
             updateVisualization(deltaTime);
             render();
 
-            SDL_Delay(16);
+            // Scale the procedural layers to the measured work, then sleep
+            // off the rest of the frame budget
+            float workMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0f / SDL_GetPerformanceFrequency();
+            resolution.update(workMs, deltaTime);
+            float idleMs = resolution.getTargetFrameMs() - workMs;
+            if (idleMs >= 1.0f) {
+                SDL_Delay(static_cast<Uint32>(idleMs));
+            }
         }
     }
 
@@ -970,6 +589,9 @@ private:
         audioParams.smoothedAmplitude = amplitude;
         audioParams.beatDetected = beat > 0.1f;
         audioParams.beatIntensity = beat;
+        audioParams.kickPulse = engine.getDrumPulse(DrumClass::Kick);
+        audioParams.snarePulse = engine.getDrumPulse(DrumClass::Snare);
+        audioParams.hatPulse = engine.getDrumPulse(DrumClass::HiHat);
         audioParams.rotationSpeed = 1.0f + audioLevel * 2.0f;
         audioParams.globalAmplification = 1.0f + audioLevel * 0.5f;
 
@@ -993,6 +615,9 @@ private:
         float targetBg = amplitude * 100.0f + beat * 50.0f;
         backgroundIntensity = backgroundIntensity * 0.9f + targetBg * 0.1f;
 
+        // The beat is not smoothed by the engine's band followers
+        barBeatBoost += (beat * SCREEN_HEIGHT * 0.2f - barBeatBoost) * (std::min)(deltaTime * 8.0f, 1.0f);
+
         if (!freqData.empty()) {
             for (int i = 0; i < NUM_BARS; i++) {
                 int freqIndex = (i * freqData.size()) / NUM_BARS;
@@ -1001,11 +626,11 @@ private:
                 targetHeights[i] = freqData[freqIndex] * SCREEN_HEIGHT * 0.8f;
 
                 if (i < 4) {
-                    targetHeights[i] += beat * SCREEN_HEIGHT * 0.2f;
+                    targetHeights[i] += barBeatBoost;
                 }
 
-                float diff = targetHeights[i] - barHeights[i];
-                barHeights[i] += diff * deltaTime * 8.0f;
+                // Attack/release smoothing of the bands already happens in the engine
+                barHeights[i] = targetHeights[i];
 
                 if (barHeights[i] < 0) barHeights[i] = 0;
             }
@@ -1015,15 +640,96 @@ private:
             wave.update(deltaTime);
         }
 
-        if (audioLevel > 0.05f && particles.size() < PAR) {
-            Particle::PaletteType paletteType = static_cast<Particle::PaletteType>(rng() % palettes.size());
-            spawnParticles(particles, audioLevel, paletteType);
+        if (audioLevel > 0.05f && particles.size() < particles.getCapacity()) {
+            ParticlePalette paletteType = static_cast<ParticlePalette>(rng() % palettes.size());
+            spawnParticles(audioLevel, paletteType);
+        }
+
+        // New musical section: jump to a different curve and palette
+        unsigned int sectionCount = engine.getSectionChangeCount();
+        if (sectionCount != lastSectionCount) {
+            lastSectionCount = sectionCount;
+            int size = curvePlaylistSize();
+            requestCurve(curveAt((curveIndex(currentCurve) + 1 + static_cast<int>(rng() % (size - 1))) % size));
+            sectionChangePending = true;
+        }
+
+        // Kicks burst the particles apart, snares pop their scale
+        unsigned int kickCount = engine.getDrumOnsetCount(DrumClass::Kick);
+        unsigned int snareCount = engine.getDrumOnsetCount(DrumClass::Snare);
+        bool kickHit = kickCount != lastKickCount;
+        bool snareHit = snareCount != lastSnareCount;
+        lastKickCount = kickCount;
+        lastSnareCount = snareCount;
+
+        // Curve changes wait for the next kick and morph over one beat; with
+        // no kicks coming they start after a second anyway
+        if (kickHit) {
+            float interval = t - lastKickTime;
+            if (interval > 0.25f && interval < 2.0f) {
+                kickInterval += (interval - kickInterval) * 0.3f;
+            }
+            lastKickTime = t;
+            cloudBeats++;
         }
+        curveMorph.update(deltaTime);
+        if (pendingCurve >= 0 && !curveMorph.isActive()) {
+            pendingWait += deltaTime;
+            if (kickHit || pendingWait >= 1.0f) {
+                CurveAudio audio = { audioParams.smoothedBass, audioParams.smoothedMid, audioParams.smoothedTreble,
+                    audioParams.smoothedAmplitude, audioParams.beatIntensity };
+                curveMorph.start(currentCurve, pendingCurve, t, kickInterval, param1, param2, audio);
+                currentCurve = pendingCurve;
+                pendingCurve = -1;
+            }
+        }
+
+        // An interlaced plasma catches up completely on the beat
+        if (kickHit && plasmaBeatRefresh) {
+            plasmaRenderer.requestFullRefresh();
+        }
+
+        ParticleFrame particleFrame;
+        particleFrame.audioLevel = audioLevel;
+        particleFrame.beat = beat;
+        particleFrame.kickHit = kickHit;
+        particleFrame.snareHit = snareHit;
+        particleFrame.deltaTime = deltaTime;
+        particleFrame.time = static_cast<float>(SDL_GetTicks()) * 0.002f;
+        particleFrame.width = static_cast<float>(SCREEN_WIDTH);
+        particleFrame.height = static_cast<float>(SCREEN_HEIGHT);
+        particles.update(particleFrame);
+    }
+
+    // The curves 'c' and section changes step through: the first six
+    // built-in shapes, then every loaded script
+    int curvePlaylistSize() const {
+        return 6 + getCurveScriptCount();
+    }
 
-        updateParticles(particles, audioLevel, beat, deltaTime);
+    int curveAt(int index) const {
+        return index < 6 ? index : kCurveTypeCount + index - 6;
     }
 
-    void spawnParticles(std::vector<Particle>& particles, float audioLevel, Particle::PaletteType paletteType) {
+    int curveIndex(int type) const {
+        return type < kCurveTypeCount ? type % 6 : 6 + type - kCurveTypeCount;
+    }
+
+    std::string curveName(int type) const {
+        const CurveProgram* script = getCurveScript(type - kCurveTypeCount);
+        return script ? script->getName() + " (scripted)" : std::to_string(type);
+    }
+
+    void requestCurve(int type) {
+        if (type == currentCurve && !curveMorph.isActive()) {
+            pendingCurve = -1;
+            return;
+        }
+        pendingCurve = type;
+        pendingWait = 0.0f;
+    }
+
+    void spawnParticles(float audioLevel, ParticlePalette paletteType) {
         int count = static_cast<int>(audioLevel * 8.0f) + 1;
 
         const auto& palette = palettes[static_cast<size_t>(paletteType)];
@@ -1031,42 +737,22 @@ private:
             float x = static_cast<float>(rng() % SCREEN_WIDTH);
             float y = static_cast<float>(rng() % SCREEN_HEIGHT);
 
-            SDL_Color color = palette[static_cast<size_t>(rng()) % palette.size()];
-
-            Particle::Shape shape;
-            int shapeRand = rng() % 6;
-            if (shapeRand == 0) shape = Particle::Shape::Circle;
-            else if (shapeRand == 1) shape = Particle::Shape::Rectangle;
-            else if (shapeRand == 2) shape = Particle::Shape::Star;
-            else if (shapeRand == 3) shape = Particle::Shape::Triangle;
-            else if (shapeRand == 4) shape = Particle::Shape::Pentagon;
-            else shape = Particle::Shape::Hexagon;
-
-            Particle p(x, y, color, shape, paletteType);
-            p.frequency = 0.1f + (static_cast<float>(rng()) / rng.max()) * 0.3f;
-            p.amplitude = 30.0f + audioLevel * 50.0f;
-            p.maxLife = 0.8f + audioLevel * 2.0f;
-            p.life = p.maxLife;
-            p.rotationSpeed = (static_cast<float>(rng()) / rng.max() - 0.5f) * 3.0f;
-            p.scaleSpeed = (static_cast<float>(rng()) / rng.max() - 0.5f) * 0.7f;
-            p.gravity = 0.001f;
-            p.vx = (static_cast<float>(rng()) / rng.max() - 0.5f) * 300.0f;
-            p.vy = (static_cast<float>(rng()) / rng.max() - 0.5f) * 300.0f;
-
-            particles.push_back(p);
+            ParticleStyle style;
+            style.color = palette[static_cast<size_t>(rng()) % palette.size()];
+            style.shape = static_cast<ParticleShape>(rng() % 6);
+            style.palette = paletteType;
+            style.maxLife = 0.8f + audioLevel * 2.0f;
+
+            int p = particles.add(x, y, style);
+            if (p < 0) break;
+            particles.getFrequency()[p] = 0.1f + (static_cast<float>(rng()) / rng.max()) * 0.3f;
+            particles.getLife()[p] = style.maxLife;
+            particles.getRotationSpeed()[p] = (static_cast<float>(rng()) / rng.max() - 0.5f) * 3.0f;
+            particles.getVX()[p] = (static_cast<float>(rng()) / rng.max() - 0.5f) * 300.0f;
+            particles.getVY()[p] = (static_cast<float>(rng()) / rng.max() - 0.5f) * 300.0f;
         }
     }
 
-    void updateParticles(std::vector<Particle>& particles, float audioLevel, float beat, float deltaTime) {
-        for (size_t i = 0; i < particles.size(); ++i) {
-            particles[i].update(audioLevel, beat, deltaTime, particles, i);
-        }
-
-        particles.erase(std::remove_if(particles.begin(), particles.end(),
-            [](const Particle& p) { return !p.isAlive(); }),
-            particles.end());
-    }
-
     void drawBackgroundWaves(float deltaTime) {
         float time = static_cast<float>(SDL_GetTicks());
         float beat = engine.getBeat();
@@ -1098,72 +784,71 @@ private:
 
      
 
-    void drawParticles(const std::vector<Particle>& particles) {
-        for (const auto& particle : particles) {
-            Uint32 color = (particle.color.a << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b;
-            int x = static_cast<int>(particle.x);
-            int y = static_cast<int>(particle.y);
-            int size = static_cast<int>(particle.size * particle.scale);
-
-            switch (particle.shape) {
-            case Particle::Shape::Circle:
-                filledCircleColor(renderer, x, y, size / 2, color);
-                if (size > 6) {
-                    circleColor(renderer, x, y, size, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
+    // Every particle as a filled polygon plus a faint outline once it is
+    // large enough, all in one geometry batch
+    void drawParticles(const ParticleSystem& particles) {
+        particleGeometry.clear();
+        float px[13], py[13];
+        for (int p = 0; p < particles.size(); p++) {
+            float x = particles.getX()[p];
+            float y = particles.getY()[p];
+            ParticleShape shape = particles.getStyles()[p].shape;
+            SDL_Color color = particles.getColor(p);
+            int size = static_cast<int>(particles.getParticleSize() * particles.getScale()[p]);
+            float half = static_cast<float>(size / 2);
+            int corners = 0;
+            auto corner = [&](float cx, float cy) { px[corners] = cx; py[corners] = cy; corners++; };
+
+            switch (shape) {
+            case ParticleShape::Circle:
+                for (int i = 0; i < 12; i++) {
+                    corner(x + half * std::cos(TWO_PI * i / 12), y + half * std::sin(TWO_PI * i / 12));
                 }
                 break;
-            case Particle::Shape::Rectangle:
-                boxColor(renderer, x - size / 2, y - size / 2, x + size / 2, y + size / 2, color);
-                if (size > 6) {
-                    rectangleColor(renderer, x - size, y - size, x + size, y + size, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
-                }
+            case ParticleShape::Rectangle:
+                corner(x - half, y - half);
+                corner(x + half, y - half);
+                corner(x + half, y + half);
+                corner(x - half, y + half);
                 break;
-            case Particle::Shape::Star: {
-                Sint16 vx[4] = { x, x + size / 2, x, x - size / 2 };
-                Sint16 vy[4] = { y - size / 2, y, y + size / 2, y };
-                filledPolygonColor(renderer, vx, vy, 4, color);
-                if (size > 6) {
-                    polygonColor(renderer, vx, vy, 4, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
-                }
+            case ParticleShape::Star:
+                corner(x, y - half);
+                corner(x + half, y);
+                corner(x, y + half);
+                corner(x - half, y);
                 break;
-            }
-            case Particle::Shape::Triangle: {
-                Sint16 vx[3] = { x, x + size / 2, x - size / 2 };
-                Sint16 vy[3] = { y - size / 2, y + size / 2, y + size / 2 };
-                filledPolygonColor(renderer, vx, vy, 3, color);
-                if (size > 6) {
-                    polygonColor(renderer, vx, vy, 3, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
-                }
+            case ParticleShape::Triangle:
+                corner(x, y - half);
+                corner(x + half, y + half);
+                corner(x - half, y + half);
                 break;
-            }
-            case Particle::Shape::Pentagon: {
-                Sint16 vx[5], vy[5];
-                for (int i = 0; i < 5; i++) {
-                    float angle = particle.rotation + i * 2.0f * M_PI / 5.0f;
-                    vx[i] = x + size / 2 * cos(angle);
-                    vy[i] = y + size / 2 * sin(angle);
-                }
-                filledPolygonColor(renderer, vx, vy, 5, color);
-                if (size > 6) {
-                    polygonColor(renderer, vx, vy, 5, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
+            case ParticleShape::Pentagon:
+            case ParticleShape::Hexagon: {
+                int sides = shape == ParticleShape::Pentagon ? 5 : 6;
+                for (int i = 0; i < sides; i++) {
+                    float angle = particles.getRotation()[p] + i * TWO_PI / sides;
+                    corner(x + half * std::cos(angle), y + half * std::sin(angle));
                 }
                 break;
             }
-            case Particle::Shape::Hexagon: {
-                Sint16 vx[6], vy[6];
-                for (int i = 0; i < 6; i++) {
-                    float angle = particle.rotation + i * 2.0f * M_PI / 6.0f;
-                    vx[i] = x + size / 2 * cos(angle);
-                    vy[i] = y + size / 2 * sin(angle);
-                }
-                filledPolygonColor(renderer, vx, vy, 6, color);
-                if (size > 6) {
-                    polygonColor(renderer, vx, vy, 6, (particle.color.a / 4 << 24) | (particle.color.r << 16) | (particle.color.g << 8) | particle.color.b);
-                }
-                break;
             }
+            particleGeometry.addPolygon(px, py, corners, color);
+
+            if (size > 6) {
+                // Closed loop; circles and squares get theirs at twice the size
+                bool doubled = shape == ParticleShape::Circle || shape == ParticleShape::Rectangle;
+                for (int i = 0; doubled && i < corners; i++) {
+                    px[i] = x + (px[i] - x) * 2.0f;
+                    py[i] = y + (py[i] - y) * 2.0f;
+                }
+                px[corners] = px[0];
+                py[corners] = py[0];
+                SDL_Color outline = color;
+                outline.a /= 4;
+                particleGeometry.addRibbon(px, py, corners + 1, 0.5f, &outline, false);
             }
         }
+        particleGeometry.draw(renderer);
     }
 
     void printDebugInfo() {
@@ -1176,9 +861,53 @@ private:
         std::cout << "Audio Level: " << audioLevel << std::endl;
         std::cout << "Amplitude: " << amplitude << std::endl;
         std::cout << "Beat: " << beat << std::endl;
+        std::cout << "Drum Pulses (kick/snare/hat): " << engine.getDrumPulse(DrumClass::Kick) << " / "
+            << engine.getDrumPulse(DrumClass::Snare) << " / " << engine.getDrumPulse(DrumClass::HiHat) << std::endl;
         std::cout << "Freq Data Size: " << freqData.size() << std::endl;
-        std::cout << "Particle Count: " << particles.size() << std::endl;
-        std::cout << "Current Curve Type: " << currentCurve << std::endl;
+        const ParticleStats& particleStats = particles.getStats();
+        std::cout << "Particle Count: " << particles.size() << " of " << particles.getCapacity() << " | update "
+            << particleStats.averageMs << " ms | " << particleStats.collisions << " collisions" << std::endl;
+        std::cout << "Current Curve Type: " << curveName(currentCurve) << " | " << getCurveScriptCount()
+            << " scripted curves loaded" << std::endl;
+        std::cout << "Novelty: " << engine.getNovelty() << " (sections: " << engine.getSectionChangeCount() << ")" << std::endl;
+        std::cout << "Frame Work: " << resolution.getAverageFrameMs() << " ms of " << resolution.getTargetFrameMs()
+            << " ms | Resolution Scale: " << resolution.getScale() << (resolution.isEnabled() ? " (dynamic)" : " (fixed)")
+            << " | Plasma Kernel: " << PlasmaRenderer::kernelName(plasmaRenderer.getKernel()) << std::endl;
+        std::cout << "Textures: " << textures.getTextureCount() << " using "
+            << textures.getTotalBytes() / (1024.0 * 1024.0) << " MB (" << textures.getPooledBytes() / (1024.0 * 1024.0)
+            << " MB pooled) | created " << textures.getCreatedCount() << ", reused " << textures.getReusedCount()
+            << ", evicted " << textures.getEvictedCount() << std::endl;
+        const CurveCompositorStats& curveStats = curveCompositor.getStats();
+        std::cout << "Curve layers: " << curveStats.layers << " on " << workerPool.size() << " workers, "
+            << curveStats.averageMs << " ms | " << curveStats.points << " points of " << curveCompositor.getPointBudget()
+            << " budget, " << curveStats.evaluations << " evaluations | tolerance " << curveCompositor.getTolerance() << " px"
+            << (curveStats.budgetLimited > 0 ? " | " + std::to_string(curveStats.budgetLimited) + " budget limited" : "")
+            << (curveStats.sanitized > 0 ? " | " + std::to_string(curveStats.sanitized) + " points clamped" : "")
+            << std::endl;
+        std::cout << "Curve morph: " << (curveMorph.isActive() ? std::to_string(curveMorph.getFromType()) + " -> " +
+            std::to_string(curveMorph.getToType()) + " at " + std::to_string(curveMorph.getWeight()) : std::string("idle"))
+            << (pendingCurve >= 0 ? " | next " + std::to_string(pendingCurve) + " on the beat" : std::string())
+            << " | by " << (curveMorph.getArcLength() ? "arc length" : "angle") << " | beat " << kickInterval << " s"
+            << " | cache " << curveMorph.getCache().getHitCount() << " hits, " << curveMorph.getCache().getMissCount()
+            << " misses" << std::endl;
+        std::cout << "Curve geometry: " << curveCompositor.getGeometry().getVertexCount() << " vertices, "
+            << curveCompositor.getGeometry().getTriangleCount() << " triangles in one draw call" << std::endl;
+        const PointCloudStats& cloudStats = pointCloud.getStats();
+        if (pointCloudEnabled) {
+            std::cout << "Point cloud: " << cloudStats.points << " points, " << cloudStats.drawn << " drawn | transform "
+                << cloudStats.transformMs << " ms, depth sort " << cloudStats.sortMs << " ms, sprites "
+                << cloudStats.geometryMs << " ms" << std::endl;
+        }
+        else {
+            std::cout << "Point cloud: off" << std::endl;
+        }
+        const PlasmaStats& plasmaStats = plasmaRenderer.getStats();
+        double pixelShare = plasmaStats.pixelsDisplayed > 0 ? (double)plasmaStats.pixelsEvaluated / plasmaStats.pixelsDisplayed : 1.0;
+        std::cout << "Plasma: " << PlasmaRenderer::engineName(plasmaRenderer.getEngine()) << ", "
+            << plasmaStats.averageMs << " ms/frame | interlace 1/" << plasmaRenderer.getInterlace()
+            << " | kaleidoscope " << plasmaRenderer.getKaleidoscope() << "-fold"
+            << " | pixels evaluated " << pixelShare * 100.0 << "% (saved " << (1.0 - pixelShare) * 100.0 << "%)"
+            << " | full refreshes " << plasmaStats.fullRefreshes << (plasmaBeatRefresh ? " (on beats)" : "") << std::endl;
 
         if (!freqData.empty()) {
             std::cout << "First 8 frequency values: ";
@@ -1283,8 +1012,9 @@ private:
     }
     void plasma2(float audioBassLevel = 0.5f, float deltaTime = 0.016f) {
         static float t = 0.0f;
-        static SDL_Texture* plasmaTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+        SDL_Texture* plasmaTex = textures.acquire("plasma2", SDL_PIXELFORMAT_RGBA8888,
             SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (!plasmaTex) return;
         static int currentPaletteIndex = rand() % 6;
         static int nextPaletteIndex = rand() % 6;
         static float paletteTransitionTime = 0.2f;
@@ -1412,120 +1142,36 @@ private:
 
  
 
-    SDL_Color plasmaRgb(float hue, float saturation, float brightness, int palette) {
-        SDL_Color rgb;
-
-        switch (palette) {
-        case 0: // Ice and Frost
-            if (hue < 120) {
-                hue = fmodf(hue * 2.5f, 240.0f);
-                saturation = 80.0f + 20.0f * sinf(hue * 0.01f);
-                brightness = 70.0f + 30.0f * cosf(hue * 0.01f);
-            }
-            else if (hue < 240) {
-                hue = fmodf((hue - 120.0f) * 2.0f, 120.0f);
-                saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
-                brightness = 80.0f + 20.0f * cosf(hue * 0.01f);
-            }
-            else {
-                hue = fmodf((hue - 240.0f) * 3.0f, 120.0f);
-                saturation = 100.0f;
-                brightness = 90.0f + 10.0f * sinf(hue * 0.01f);
-            }
-            break;
-
-        case 1: // Deep Blue
-            hue = fmodf(hue * 1.5f, 240.0f);
-            saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
-            brightness = 40.0f + 20.0f * cosf(hue * 0.01f);
-            break;
-
-        case 2: // Smoke Volcano
-            if (hue < 120) {
-                hue = fmodf(hue * 2.0f, 120.0f);
-                saturation = 60.0f + 20.0f * sinf(hue * 0.01f);
-                brightness = 50.0f + 30.0f * cosf(hue * 0.01f);
-            }
-            else {
-                hue = fmodf((hue - 120.0f) * 2.0f, 120.0f);
-                saturation = 80.0f + 10.0f * sinf(hue * 0.01f);
-                brightness = 70.0f + 20.0f * cosf(hue * 0.01f);
-            }
-            break;
-
-        case 3: // Electric Storm
-            hue = fmodf(hue * 2.0f, 360.0f);
-            saturation = 100.0f;
-            brightness = 80.0f + 20.0f * sinf(hue * 0.01f);
-            break;
-
-        case 4: // Toxic Waste
-            hue = fmodf(hue * 1.5f, 120.0f);
-            saturation = 80.0f + 20.0f * sinf(hue * 0.01f);
-            brightness = 60.0f + 30.0f * cosf(hue * 0.01f);
-            break;
-
-        case 5: // Neon Dreams
-            hue = fmodf(hue * 2.5f, 360.0f);
-            saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
-            brightness = 90.0f + 10.0f * cosf(hue * 0.01f);
-            break;
-        }
-
-        // Convert HSB to RGB
-        float r, g, b;
-        int hi = (int)(hue / 60.0f) % 6;
-        float f = hue / 60.0f - hi;
-        float p = brightness * (1.0f - saturation / 100.0f);
-        float q = brightness * (1.0f - f * saturation / 100.0f);
-        float t = brightness * (1.0f - (1.0f - f) * saturation / 100.0f);
-
-        switch (hi) {
-        case 0: r = brightness; g = t; b = p; break;
-        case 1: r = q; g = brightness; b = p; break;
-        case 2: r = p; g = brightness; b = t; break;
-        case 3: r = p; g = q; b = brightness; break;
-        case 4: r = t; g = p; b = brightness; break;
-        case 5: r = brightness; g = p; b = q; break;
-        }
-
-        rgb.r = (Uint8)(r * 255.0f / 100.0f);
-        rgb.g = (Uint8)(g * 255.0f / 100.0f);
-        rgb.b = (Uint8)(b * 255.0f / 100.0f);
-        rgb.a = 255;
-
-        return rgb;
-    }
-
     void plasma(float audioBassLevel,   float deltaTime = 0.016f) {
         static float t = 0.0f;
-        static SDL_Texture* plasmaTex = NULL;
-        if (!plasmaTex) {
-            plasmaTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
-                SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
-        }
+        // Internal resolution follows the frame-time controller
+        int plasmaWidth = resolution.scaled(SCREEN_WIDTH);
+        int plasmaHeight = resolution.scaled(SCREEN_HEIGHT);
+        SDL_Texture* plasmaTex = textures.acquire("plasma", SDL_PIXELFORMAT_RGBA8888,
+            SDL_TEXTUREACCESS_STREAMING, plasmaWidth, plasmaHeight);
+        if (!plasmaTex) return;
         static int currentPaletteIndex = rand() % 6;
         static int nextPaletteIndex = rand() % 6;
         static float paletteTransitionTime = 0.2f;
         const float transitionDuration = 10.0f; // 20 seconds
+        // Random seed for shape variation. The polar, index and table caches
+        // in the plasma renderer are keyed on it, so it changes only once
+        // per palette switch.
+        static float shapeSeed = (float)rand() / RAND_MAX;
 
         t += deltaTime;
         paletteTransitionTime += deltaTime;
 
-        if (paletteTransitionTime >= transitionDuration) {
+        if (paletteTransitionTime >= transitionDuration || sectionChangePending) {
             currentPaletteIndex = nextPaletteIndex;
             nextPaletteIndex = rand() % 6;
             paletteTransitionTime = 0.1f;
+            sectionChangePending = false;
+            shapeSeed = (float)rand() / RAND_MAX; // New random seed per palette switch
         }
 
         float paletteInterpolation = paletteTransitionTime / transitionDuration;
 
-        // Random seed for shape variation
-        static float shapeSeed = (float)rand() / RAND_MAX;
-        if (paletteTransitionTime < 0.2f) {
-            shapeSeed = (float)rand() / RAND_MAX; // New random seed per palette switch
-        }
-
         // Time-based parameters with random variation
         float time1 = t * (0.3f + 0.1f * shapeSeed);
         float time2 = t * (0.5f + 0.2f * shapeSeed);
@@ -1536,67 +1182,32 @@ private:
         float audioInfluence = 0.7f + 0.9f * audioBassLevel;
         float swirlFactor = 1.0f * audioInfluence;
 
+        PlasmaFrame frame;
+        frame.t = t;
+        frame.time1 = time1;
+        frame.time2 = time2;
+        frame.time3 = time3;
+        frame.colorCycle = colorCycle;
+        frame.shapeSeed = shapeSeed;
+        frame.swirlFactor = swirlFactor;
+        frame.audioBassLevel = audioBassLevel;
+        frame.paletteInterpolation = paletteInterpolation;
+        frame.currentPalette = currentPaletteIndex;
+        frame.nextPalette = nextPaletteIndex;
+
+        // The workers fill the texture, this thread only waits for them
         void* pixels;
         int pitch;
         SDL_LockTexture(plasmaTex, nullptr, &pixels, &pitch);
-        Uint32* pixelBuffer = static_cast<Uint32*>(pixels);
-
-        // Precompute screen aspect and center
-        float aspect = SCREEN_WIDTH / (float)SCREEN_HEIGHT;
-        float centerX = SCREEN_WIDTH / 2.0f;
-        float centerY = SCREEN_HEIGHT / 2.0f;
-
-        // Generate plasma pattern with random shape variations
-        for (int y = 0; y < SCREEN_HEIGHT; ++y) {
-            float ny = ((y - centerY) / centerY) * (1.0f + 0.2f * shapeSeed);
-
-            for (int x = 0; x < SCREEN_WIDTH; ++x) {
-                float nx = ((x - centerX) / centerX) * aspect;
-
-                // Swirling transformation with random perturbation
-                float angle = atan2f(ny, nx) + 0.5f * sinf(t * 0.1f + shapeSeed);
-                float radius = sqrtf(nx * nx + ny * ny);
-
-                // Dynamic swirl modulated by time, audio, and random seed
-                angle += swirlFactor / (radius + 0.3f + 0.2f * shapeSeed) + time1;
-                radius = radius * (0.8f + 0.3f * sinf(time2 * (0.5f + shapeSeed)));
-
-                float sx = radius * cosf(angle);
-                float sy = radius * sinf(angle);
-
-                // Multiple sine waves with random coefficients for varied patterns
-                float value =
-                    0.50f * sinf(sx * (7.0f + 3.0f * shapeSeed) + time1) +
-                    0.35f * sinf(sy * (9.0f + 4.0f * shapeSeed) + time2) +
-                    0.25f * sinf((sx + sy) * (5.0f + 2.0f * shapeSeed) + time3) +
-                    0.30f * sinf(radius * (15.0f + 5.0f * shapeSeed) + colorCycle);
-                value = (value + 1.0f) * 0.5f;
-
-                // Dynamic HSB color with audio-reactive brightness
-                float hue = fmodf(colorCycle * 40.0f + value * 120.0f + radius * (60.0f + 20.0f * shapeSeed), 360.0f);
-                float saturation = 70.0f + 30.0f * sinf(time3 + shapeSeed);
-                float brightness = 20.0f + 60.0f * value + 30.0f * audioBassLevel;
-
-                SDL_Color currentColor = plasmaRgb(hue, saturation, brightness, currentPaletteIndex);
-                SDL_Color nextColor = plasmaRgb(hue, saturation, brightness, nextPaletteIndex);
-
-                SDL_Color interpolatedColor;
-                interpolatedColor.r = (Uint8)((1.0f - paletteInterpolation) * currentColor.r + paletteInterpolation * nextColor.r);
-                interpolatedColor.g = (Uint8)((1.0f - paletteInterpolation) * currentColor.g + paletteInterpolation * nextColor.g);
-                interpolatedColor.b = (Uint8)((1.0f - paletteInterpolation) * currentColor.b + paletteInterpolation * nextColor.b);
-                interpolatedColor.a = 255;
-
-                // Write pixel (RGBA8888: assuming little-endian ABGR layout)
-                pixelBuffer[y * (pitch / 4) + x] =
-                    (0xFF << 24) | (interpolatedColor.b << 16) | (interpolatedColor.g << 8) | interpolatedColor.r;
-            }
-        }
-
+        plasmaRenderer.render(workerPool, frame, pixels, pitch, plasmaWidth, plasmaHeight);
         SDL_UnlockTexture(plasmaTex);
 
-        // Render plasma background
+        // Render plasma background, stretched to the screen
         SDL_RenderCopy(renderer, plasmaTex, nullptr, nullptr);
 
+        float centerX = SCREEN_WIDTH / 2.0f;
+        float centerY = SCREEN_HEIGHT / 2.0f;
+
         // Add vortex overlay with additive blending and random shape variations
         SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
         for (int i = 0; i < 3; ++i) {
@@ -1771,9 +1382,12 @@ private:
         // Draw background waves
         drawBackgroundWaves(1.0f / 60.0f);
 
+        if (pointCloudEnabled) {
+            drawPointCloud();
+        }
+
         // Draw curves
-            drawCurveType(curveTexture, currentCurve, 0.9f);
-        SDL_RenderCopy(renderer, curveTexture, nullptr, nullptr);
+        drawCurves();
 
        
        
@@ -1811,6 +1425,7 @@ private:
        // SDL_RenderFillRect(renderer, &statusRect);
 
         SDL_RenderPresent(renderer);
+        textures.endFrame();
     }
 
 
@@ -1818,10 +1433,7 @@ private:
     void cleanup() {
         engine.cleanup();
 
-        if (curveTexture) {
-            SDL_DestroyTexture(curveTexture);
-            curveTexture = nullptr;
-        }
+        textures.clear();
         if (renderer) {
             SDL_DestroyRenderer(renderer);
             renderer = nullptr;
@@ -1836,7 +1448,70 @@ private:
 };
 
 int main(int argc, char* args[]) {
+    // Options, parsed in one pass and applied below
+    const std::string engineOption = "--plasma-engine=";
+    const std::string layersOption = "--curve-layers=";
+    const std::string curvesOption = "--curves=";
+    bool runBench = false;
+    bool runValidation = false;
+    bool pointCloud = false;
+    bool engineSet = false;
+    PlasmaEngine plasmaEngine = PlasmaEngine::Field;
+    int curveLayers = 0;          // 0 keeps the default
+    std::string curvesPath;       // empty keeps curves.txt
+    for (int i = 1; i < argc; i++) {
+        std::string arg(args[i]);
+        // --bench: run the analysis pipeline over the synthetic signals and exit
+        if (arg == "--bench") {
+            runBench = true;
+        }
+        // --validate-curves: sweep every curve type over its parameters and exit
+        else if (arg == "--validate-curves") {
+            runValidation = true;
+        }
+        // --point-cloud starts with the 3D layer on ('3' toggles it)
+        else if (arg == "--point-cloud") {
+            pointCloud = true;
+        }
+        // --plasma-engine=field|cycle|fixed picks the background renderer
+        else if (arg.compare(0, engineOption.size(), engineOption) == 0) {
+            if (PlasmaRenderer::parseEngine(arg.substr(engineOption.size()), plasmaEngine)) {
+                engineSet = true;
+            }
+            else {
+                std::cerr << "Unknown plasma engine: " << arg.substr(engineOption.size()) << std::endl;
+            }
+        }
+        // --curve-layers=N draws N simultaneous curves (1 to MAX_CURVE_LAYERS)
+        else if (arg.compare(0, layersOption.size(), layersOption) == 0) {
+            curveLayers = (std::max)(1, std::atoi(arg.c_str() + layersOption.size()));
+        }
+        // --curves=path loads the scripted curves from another file
+        else if (arg.compare(0, curvesOption.size(), curvesOption) == 0) {
+            curvesPath = arg.substr(curvesOption.size());
+        }
+    }
+
+    if (runBench) {
+        AudioEngine bench;
+        bench.runAnalysisBenchmark();
+        ThreadPool pool;
+        bool plasmaOk = PlasmaRenderer::runBenchmark(pool, 1920, 1080);
+        std::cout << "Benchmark results written to the debug log." << std::endl;
+        return plasmaOk ? 0 : 1;
+    }
+    if (runValidation) {
+        loadCurveScripts(curvesPath.empty() ? "curves.txt" : curvesPath);
+        bool curvesOk = runCurveValidation(TIME_SLOWDOWN);
+        std::cout << "Curve validation results written to the debug log." << std::endl;
+        return curvesOk ? 0 : 1;
+    }
+
     SimpleVisualizer viz;
+    if (engineSet) viz.setPlasmaEngine(plasmaEngine);
+    if (curveLayers > 0) viz.setCurveLayerCount(curveLayers);
+    if (pointCloud) viz.setPointCloud(true);
+    if (!curvesPath.empty()) viz.setCurveScriptPath(curvesPath);
 
     HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
     if (FAILED(hr)) {
@@ -0,0 +1,17 @@
+// audio_source.h
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Anything that can feed the engine interleaved stereo float frames from
+// its own thread: the WASAPI loopback capture or the synthetic generator.
+class AudioSource {
+public:
+    using Callback = std::function<void(const float* data, size_t frames)>;
+
+    virtual ~AudioSource() {}
+
+    virtual bool initialize(Callback cb) = 0;
+    virtual void shutdown() = 0;
+};
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "curve_compositor.h"
+
+namespace {
+    // Pixels from the center. Far off-screen, but after rotation and
+    // centering still inside the Sint16 range the fallback renderer uses
+    const float kPointLimit = 8192.0f;
+}
+
+CurveCompositor::CurveCompositor(int pointBudget) : pointBudget(pointBudget), tolerance(1.0f) {
+    stats = CurveCompositorStats();
+}
+
+void CurveCompositor::setTolerance(float pixels) {
+    if (pixels > 0.0f) tolerance = pixels;
+}
+
+void CurveCompositor::buildLayer(const CurveLayerFrame& frame, Workspace& workspace, int budget) {
+    CurveTessellator& tessellator = workspace.tessellator;
+    tessellator.setTolerance(tolerance);
+    tessellator.setPointBudget(budget);
+    tessellator.beginFrame();
+
+    const int markers = (std::min)((std::max)(frame.markerCount, 0), kMaxCurveMarkers);
+    float markerTheta[kMaxCurveMarkers];
+    float markerX[kMaxCurveMarkers];
+    float markerY[kMaxCurveMarkers];
+
+    int count;
+    if (frame.morph) {
+        count = frame.morph->evaluate(frame.morphScale, workspace.x, workspace.y);
+        for (int m = 0; m < markers; m++) {
+            int index = markers > 1 ? (m * (count - 1) + (markers - 1) / 2) / (markers - 1) : 0;
+            markerX[m] = workspace.x[index];
+            markerY[m] = workspace.y[index];
+        }
+    }
+    else {
+        count = tessellator.tessellate(frame.kernel, frame.params, frame.thetaEnd, workspace.theta,
+            workspace.x, workspace.y);
+        for (int m = 0; m < markers; m++) {
+            markerTheta[m] = markers > 1 ? frame.thetaEnd * m / (markers - 1) : 0.0f;
+        }
+        if (markers > 0) frame.kernel(frame.params, markerTheta, markerX, markerY, markers);
+    }
+    workspace.points = count;
+    workspace.sanitized = sanitizeCurvePoints(workspace.x.data(), workspace.y.data(), count, kPointLimit) +
+        sanitizeCurvePoints(markerX, markerY, markers, kPointLimit);
+
+    // Curve space to screen space, in place
+    const float cosRotation = std::cos(frame.rotation);
+    const float sinRotation = std::sin(frame.rotation);
+    auto toScreen = [&](float& x, float& y) {
+        float px = x;
+        float py = y;
+
+        float rPoint = std::sqrt(px * px + py * py);
+        if (rPoint < frame.minDistance) {
+            float scaleFactor = frame.minDistance / (rPoint + 0.01f);
+            px *= scaleFactor;
+            py *= scaleFactor;
+        }
+
+        x = px * cosRotation - py * sinRotation + frame.centerX;
+        y = px * sinRotation + py * cosRotation + frame.centerY;
+    };
+    float* x = workspace.x.data();
+    float* y = workspace.y.data();
+    for (int i = 0; i < count; i++) {
+        toScreen(x[i], y[i]);
+    }
+    for (int m = 0; m < markers; m++) {
+        toScreen(markerX[m], markerY[m]);
+    }
+
+    // Glow under the line, then the line, then the markers on top
+    CurveGeometry& geometry = workspace.geometry;
+    geometry.clear();
+    geometry.addGlow(x, y, count, frame.glowWidth, frame.glowColor);
+    geometry.addRibbon(x, y, count, frame.lineWidth, &frame.lineColor, false);
+    for (int m = 0; m < markers; m++) {
+        geometry.addDisc(markerX[m], markerY[m], frame.markerRadius, frame.markerColors[m]);
+    }
+}
+
+void CurveCompositor::compose(ThreadPool& pool, const std::vector<CurveLayerFrame>& frames) {
+    auto start = std::chrono::steady_clock::now();
+
+    const int layers = static_cast<int>(frames.size());
+    if (static_cast<int>(workspaces.size()) < layers) {
+        workspaces.resize(layers);
+    }
+    const int budget = pointBudget / (std::max)(layers, 1);
+    if (layers == 1) {
+        // Not worth waking the workers for
+        buildLayer(frames[0], workspaces[0], budget);
+    }
+    else if (layers > 1) {
+        pool.parallelFor(layers, [&](int layer) {
+            buildLayer(frames[layer], workspaces[layer], budget);
+        });
+    }
+
+    float averageMs = stats.averageMs;
+    stats = CurveCompositorStats();
+    stats.layers = layers;
+    merged.clear();
+    for (int layer = 0; layer < layers; layer++) {
+        const Workspace& workspace = workspaces[layer];
+        merged.append(workspace.geometry);
+        stats.points += workspace.points;
+        stats.evaluations += workspace.tessellator.getStats().evaluations;
+        stats.sanitized += workspace.sanitized;
+        if (workspace.tessellator.getStats().budgetLimited > 0) stats.budgetLimited++;
+    }
+
+    float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.averageMs = averageMs > 0.0f ? averageMs + 0.05f * (elapsedMs - averageMs) : elapsedMs;
+}
@@ -0,0 +1,87 @@
+#ifndef CURVE_COMPOSITOR_H
+#define CURVE_COMPOSITOR_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "curve_geometry.h"
+#include "curve_kernels.h"
+#include "curve_morph.h"
+#include "curve_tessellator.h"
+#include "thread_pool.h"
+
+const int kMaxCurveMarkers = 8;
+
+// One layer's frame, resolved on the render thread from the audio state.
+// The workers only evaluate points and build geometry from it.
+struct CurveLayerFrame {
+    CurveBatchKernel kernel;
+    CurveParams params;
+    CurveMorph* morph;        // if set the points come from the morph instead, scaled by morphScale
+    float morphScale;
+    float thetaEnd;
+    float rotation;
+    float centerX;
+    float centerY;
+    float minDistance;        // points nearer the center are pushed out to it
+    float glowWidth;
+    float lineWidth;
+    SDL_Color glowColor;
+    SDL_Color lineColor;
+    int markerCount;          // evenly spaced in theta, at most kMaxCurveMarkers
+    float markerRadius;
+    SDL_Color markerColors[kMaxCurveMarkers];
+};
+
+struct CurveCompositorStats {
+    int layers;
+    int points;
+    int evaluations;
+    int budgetLimited;    // layers that ran into their share of the budget
+    int sanitized;        // points clamped or replaced because they were out of range or NaN
+    float averageMs;      // compose(), smoothed
+};
+
+// Draws any number of curve layers as one geometry batch. Each layer has a
+// workspace of its own (tessellator, point arrays, geometry), so layers are
+// evaluated and turned into triangles in parallel on the thread pool; the
+// per-layer batches are then appended in order into the merged one that
+// draw() submits. The point budget is split evenly between the layers.
+//
+// A morph is evaluated by the worker of the layer that uses it and must not
+// be shared between layers.
+class CurveCompositor {
+private:
+    struct Workspace {
+        CurveTessellator tessellator;
+        std::vector<float> theta;
+        std::vector<float> x;
+        std::vector<float> y;
+        CurveGeometry geometry;
+        int points = 0;
+        int sanitized = 0;
+    };
+
+    std::vector<Workspace> workspaces;
+    CurveGeometry merged;
+    int pointBudget;
+    float tolerance;
+    CurveCompositorStats stats;
+
+    void buildLayer(const CurveLayerFrame& frame, Workspace& workspace, int budget);
+
+public:
+    explicit CurveCompositor(int pointBudget = 4096);
+
+    void setTolerance(float pixels);
+    float getTolerance() const { return tolerance; }
+    int getPointBudget() const { return pointBudget; }
+
+    // Builds the layers in frames, the first one at the bottom
+    void compose(ThreadPool& pool, const std::vector<CurveLayerFrame>& frames);
+    bool draw(SDL_Renderer* renderer) const { return merged.draw(renderer); }
+
+    const CurveGeometry& getGeometry() const { return merged; }
+    const CurveCompositorStats& getStats() const { return stats; }
+};
+
+#endif // CURVE_COMPOSITOR_H
@@ -0,0 +1,183 @@
+#include <SDL2/SDL2_gfxPrimitives.h>
+#include <cmath>
+#include "curve_geometry.h"
+
+namespace {
+    const float kTwoPi = 6.28318530718f;
+}
+
+void CurveGeometry::clear() {
+    vertices.clear();
+    indices.clear();
+}
+
+int CurveGeometry::addVertex(float x, float y, SDL_Color color) {
+    CurveVertex vertex;
+    vertex.position.x = x;
+    vertex.position.y = y;
+    vertex.color = color;
+    vertex.tex_coord.x = 0.0f;
+    vertex.tex_coord.y = 0.0f;
+    vertices.push_back(vertex);
+    return static_cast<int>(vertices.size()) - 1;
+}
+
+void CurveGeometry::computeNormals(const float* x, const float* y, int count) {
+    normals.resize(count);
+    SDL_FPoint last = { 0.0f, -1.0f };
+    for (int i = 0; i < count; i++) {
+        // Central difference, one-sided at the ends
+        int prev = i > 0 ? i - 1 : i;
+        int next = i < count - 1 ? i + 1 : i;
+        float tx = x[next] - x[prev];
+        float ty = y[next] - y[prev];
+        float length = std::sqrt(tx * tx + ty * ty);
+        if (length > 1e-4f) {
+            last.x = -ty / length;
+            last.y = tx / length;
+        }
+        // Repeated points keep the previous direction
+        normals[i] = last;
+    }
+}
+
+void CurveGeometry::addRibbon(const float* x, const float* y, int count, float halfWidth,
+    const SDL_Color* colors, bool perPoint) {
+    if (count < 2) return;
+    computeNormals(x, y, count);
+
+    int first = static_cast<int>(vertices.size());
+    for (int i = 0; i < count; i++) {
+        SDL_Color color = colors[perPoint ? i : 0];
+        float nx = normals[i].x * halfWidth;
+        float ny = normals[i].y * halfWidth;
+        addVertex(x[i] + nx, y[i] + ny, color);
+        addVertex(x[i] - nx, y[i] - ny, color);
+    }
+    for (int i = 0; i < count - 1; i++) {
+        int a = first + 2 * i;
+        int quad[6] = { a, a + 1, a + 2, a + 1, a + 3, a + 2 };
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
+
+void CurveGeometry::addGlow(const float* x, const float* y, int count, float halfWidth, SDL_Color color) {
+    if (count < 2) return;
+    computeNormals(x, y, count);
+
+    SDL_Color edge = color;
+    edge.a = 0;
+    int first = static_cast<int>(vertices.size());
+    for (int i = 0; i < count; i++) {
+        float nx = normals[i].x * halfWidth;
+        float ny = normals[i].y * halfWidth;
+        addVertex(x[i] + nx, y[i] + ny, edge);
+        addVertex(x[i], y[i], color);
+        addVertex(x[i] - nx, y[i] - ny, edge);
+    }
+    // Two quads per segment: outer edge to center, center to inner edge
+    for (int i = 0; i < count - 1; i++) {
+        int a = first + 3 * i;
+        int b = a + 3;
+        int quads[12] = { a, a + 1, b, a + 1, b + 1, b,
+            a + 1, a + 2, b + 1, a + 2, b + 2, b + 1 };
+        indices.insert(indices.end(), quads, quads + 12);
+    }
+}
+
+void CurveGeometry::addDisc(float cx, float cy, float radius, SDL_Color color, int segments) {
+    int center = addVertex(cx, cy, color);
+    for (int i = 0; i < segments; i++) {
+        float angle = kTwoPi * i / segments;
+        addVertex(cx + radius * std::cos(angle), cy + radius * std::sin(angle), color);
+    }
+    for (int i = 0; i < segments; i++) {
+        int tri[3] = { center, center + 1 + i, center + 1 + (i + 1) % segments };
+        indices.insert(indices.end(), tri, tri + 3);
+    }
+}
+
+void CurveGeometry::addPolygon(const float* x, const float* y, int count, SDL_Color color) {
+    if (count < 3) return;
+    int first = static_cast<int>(vertices.size());
+    for (int i = 0; i < count; i++) {
+        addVertex(x[i], y[i], color);
+    }
+    for (int i = 1; i < count - 1; i++) {
+        int tri[3] = { first, first + i, first + i + 1 };
+        indices.insert(indices.end(), tri, tri + 3);
+    }
+}
+
+void CurveGeometry::addSprite(float cx, float cy, float halfSize, SDL_Color color) {
+    addSprites(1);
+    setSprite(0, cx, cy, halfSize, color);
+}
+
+void CurveGeometry::addSprites(int count) {
+    spriteVertex = static_cast<int>(vertices.size());
+    spriteIndex = indices.size();
+    vertices.resize(spriteVertex + 4 * count);
+    indices.resize(spriteIndex + 6 * count);
+}
+
+void CurveGeometry::setSprite(int sprite, float cx, float cy, float halfSize, SDL_Color color) {
+    const int a = spriteVertex + 4 * sprite;
+    CurveVertex* v = &vertices[a];
+    const float corners[4][2] = { { 0.0f, -halfSize }, { halfSize, 0.0f }, { 0.0f, halfSize }, { -halfSize, 0.0f } };
+    for (int i = 0; i < 4; i++) {
+        v[i].position.x = cx + corners[i][0];
+        v[i].position.y = cy + corners[i][1];
+        v[i].color = color;
+        v[i].tex_coord.x = 0.0f;
+        v[i].tex_coord.y = 0.0f;
+    }
+    int* index = &indices[spriteIndex + 6 * sprite];
+    index[0] = a;
+    index[1] = a + 1;
+    index[2] = a + 2;
+    index[3] = a;
+    index[4] = a + 2;
+    index[5] = a + 3;
+}
+
+void CurveGeometry::append(const CurveGeometry& other) {
+    const int offset = static_cast<int>(vertices.size());
+    vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+    const size_t first = indices.size();
+    indices.resize(first + other.indices.size());
+    for (size_t i = 0; i < other.indices.size(); i++) {
+        indices[first + i] = other.indices[i] + offset;
+    }
+}
+
+bool CurveGeometry::draw(SDL_Renderer* renderer) const {
+    if (indices.empty()) return true;
+
+    // Other layers leave the draw blend mode at ADD; geometry without a
+    // texture is blended with it
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    bool ok = SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+        indices.data(), static_cast<int>(indices.size())) == 0;
+#else
+    bool ok = true;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const CurveVertex& a = vertices[indices[i]];
+        const CurveVertex& b = vertices[indices[i + 1]];
+        const CurveVertex& c = vertices[indices[i + 2]];
+        // One flat color per triangle, the average of its corners
+        ok = filledTrigonRGBA(renderer,
+            (Sint16)a.position.x, (Sint16)a.position.y, (Sint16)b.position.x, (Sint16)b.position.y,
+            (Sint16)c.position.x, (Sint16)c.position.y,
+            (Uint8)((a.color.r + b.color.r + c.color.r) / 3), (Uint8)((a.color.g + b.color.g + c.color.g) / 3),
+            (Uint8)((a.color.b + b.color.b + c.color.b) / 3), (Uint8)((a.color.a + b.color.a + c.color.a) / 3)) == 0 && ok;
+    }
+#endif
+
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+    return ok;
+}
@@ -0,0 +1,70 @@
+#ifndef CURVE_GEOMETRY_H
+#define CURVE_GEOMETRY_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+typedef SDL_Vertex CurveVertex;
+#else
+// Same layout as SDL_Vertex, which older SDL versions don't have
+struct CurveVertex {
+    SDL_FPoint position;
+    SDL_Color color;
+    SDL_FPoint tex_coord;
+};
+#endif
+
+// Triangle batch for the curve layer. Polylines are turned into ribbons
+// (two triangles per segment, the width measured along the local normal)
+// and markers into small fans, all appended to one vertex and index buffer
+// so the whole layer is a single SDL_RenderGeometry call straight onto the
+// backbuffer. Colors are per vertex: glow ribbons fade to transparent at
+// their edges instead of being drawn as several offset line strips.
+//
+// The buffers keep their capacity between frames, clear() only resets the
+// counts. With SDL older than 2.0.18 draw() falls back to SDL2_gfx
+// triangles, one call each.
+class CurveGeometry {
+private:
+    std::vector<CurveVertex> vertices;
+    std::vector<int> indices;
+    std::vector<SDL_FPoint> normals;   // scratch for addRibbon
+    int spriteVertex = 0;              // where the last addSprites() block starts
+    size_t spriteIndex = 0;
+
+    int addVertex(float x, float y, SDL_Color color);
+    void computeNormals(const float* x, const float* y, int count);
+
+public:
+    void clear();
+
+    // Solid ribbon `halfWidth` pixels either side of the polyline, colors
+    // per point (a single color if `perPoint` is false)
+    void addRibbon(const float* x, const float* y, int count, float halfWidth,
+        const SDL_Color* colors, bool perPoint);
+    // Ribbon that has `color` on the polyline and fades to alpha 0 at
+    // `halfWidth` pixels either side
+    void addGlow(const float* x, const float* y, int count, float halfWidth, SDL_Color color);
+    void addDisc(float cx, float cy, float radius, SDL_Color color, int segments = 8);
+    // Convex polygon, filled as a fan from its first corner
+    void addPolygon(const float* x, const float* y, int count, SDL_Color color);
+    // Diamond of two triangles, `halfSize` pixels from the center to each
+    // corner; the cheapest sprite for large point batches
+    void addSprite(float cx, float cy, float halfSize, SDL_Color color);
+    // Makes room for `count` sprites at the end, to be filled in with
+    // setSprite(0 .. count - 1). Different sprites may be set from
+    // different threads at once.
+    void addSprites(int count);
+    void setSprite(int sprite, float cx, float cy, float halfSize, SDL_Color color);
+    // Adds another batch on top of this one
+    void append(const CurveGeometry& other);
+
+    // Submits everything with blending, returns false if SDL failed
+    bool draw(SDL_Renderer* renderer) const;
+
+    int getVertexCount() const { return static_cast<int>(vertices.size()); }
+    int getTriangleCount() const { return static_cast<int>(indices.size() / 3); }
+};
+
+#endif // CURVE_GEOMETRY_H
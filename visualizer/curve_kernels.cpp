@@ -0,0 +1,927 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include "curve_kernels.h"
+#include "curve_script.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CURVE_KERNELS_USE_SSE2 1
+#endif
+
+// One batch kernel per curve shape. Every shape is a specialization of
+// CurveShape<N> with an inline point function, and curveBatch<N> runs it
+// over a whole array of angles, so the shape is picked once per curve
+// through the kernel table instead of once per point through a switch.
+// Inside a batch the parameters are loop invariant: the per-curve terms of
+// each formula (scaled radii, rounded petal counts, noise of tFactor) are
+// hoisted by the compiler, and the remaining loop is straight-line math on
+// contiguous arrays that the vectorizer can work on.
+
+namespace {
+    const float kTwoPi = 2.0f * static_cast<float>(M_PI);
+
+    inline float noise(float x, float y = 0.0f) {
+        float dot = x * 12.9898f + y * 78.233f;
+        float s = std::sinf(dot);
+        return s - std::floor(s); // Fast and avoids redundant computation
+    }
+
+    template <int N> struct CurveShape;
+
+    template <> struct CurveShape<0> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::cosf(p.param1 * theta) * std::cosf(theta * p.n3 + p.t);
+            y = p.r * std::sinf(p.param2 * theta) * std::sinf(theta * 0.8f - p.t / 2);
+        }
+    };
+
+    template <> struct CurveShape<1> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float spiral = p.r * (0.6f + 0.3f * noise(theta / 8 + p.t));
+            x = spiral * std::cosf(theta) + p.r / 5 * std::cosf(9 * theta + p.t * 1.3f);
+            y = spiral * std::sinf(theta) - p.r / 5 * std::sinf(7 * theta - p.t * 1.1f);
+        }
+    };
+
+    template <> struct CurveShape<2> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(theta * p.param1 + p.t * 1.3f) * std::cosf(theta * p.param2 - p.t / 2);
+            y = p.r * std::cosf(theta * p.param2 - p.t * 1.7f) * std::sinf(theta * p.param1 + p.t / 3);
+        }
+    };
+
+    template <> struct CurveShape<3> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::cosf(theta) * (1 + 0.25f * std::sinf(7 * theta + p.t * 3));
+            y = p.r * std::sinf(theta) * (1 + 0.25f * std::cosf(5 * theta - p.t * 2));
+        }
+    };
+
+    template <> struct CurveShape<4> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float vortex = p.r * (0.3f + 0.5f * std::powf(std::sinf(theta / 2 + p.t), 2));
+            x = vortex * std::cosf(theta + 5 * std::sinf(theta / 3 + p.t / 4));
+            y = vortex * std::sinf(theta + 5 * std::cosf(theta / 4 - p.t / 5));
+        }
+    };
+
+    template <> struct CurveShape<5> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(3 * theta + p.t * 1.2f) * std::cosf(2 * theta - p.t * 0.7f);
+            y = p.r * std::cosf(4 * theta - p.t * 0.9f) * std::sinf(5 * theta + p.t * 1.1f);
+        }
+    };
+
+    template <> struct CurveShape<6> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float branch = p.r * (0.4f + 0.1f * noise(theta * 5 + p.t));
+            x = branch * std::cosf(theta) * (1 + 0.3f * std::sinf(13 * theta + p.t * 2));
+            y = branch * std::sinf(theta) * (1 + 0.3f * std::cosf(11 * theta - p.t * 1.5f));
+        }
+    };
+
+    template <> struct CurveShape<7> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float orbital = p.r * (0.7f + 0.2f * std::sinf(theta * 2 + p.t * 3));
+            x = orbital * std::cosf(theta + std::sinf(theta * 7 + p.t * 2));
+            y = orbital * std::sinf(theta + std::cosf(theta * 6 - p.t * 1.8f));
+        }
+    };
+
+    template <> struct CurveShape<8> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::tanf(theta * p.param1 * 0.2f + p.t) * std::cosf(theta * p.param2 * 0.3f);
+            y = p.r * std::tanf(theta * p.param2 * 0.25f - p.t) * std::sinf(theta * p.param1 * 0.35f);
+        }
+    };
+
+    template <> struct CurveShape<9> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float flux = p.r * (0.5f + 0.3f * std::atanf(std::sinf(theta * 3 + p.t)));
+            x = flux * std::cosf(theta) + p.r / 4 * std::logf(std::fabs(5 * theta + p.t));
+            y = flux * std::sinf(theta) - p.r / 4 * std::logf(std::fabs(4 * theta - p.t));
+        }
+    };
+
+    template <> struct CurveShape<10> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::powf(std::sinf(theta * 0.7f + p.t), 3) * std::cosf(theta * 2);
+            y = p.r * std::powf(std::cosf(theta * 0.8f - p.t), 3) * std::sinf(theta * 2.5f);
+        }
+    };
+
+    template <> struct CurveShape<11> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float bio = p.r * (0.4f + 0.2f * (std::expf(std::sinf(theta + p.t)) - 0.5f));
+            x = bio * std::cosf(theta) * (1 + 0.4f * std::sinf(17 * theta + p.t * 4));
+            y = bio * std::sinf(theta) * (1 + 0.4f * std::cosf(19 * theta - p.t * 3));
+        }
+    };
+
+    template <> struct CurveShape<12> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float well = p.r * (0.3f + 0.6f / (1 + 0.5f * std::fabs(theta - M_PI + p.t)));
+            x = well * std::cosf(theta + p.t / 3);
+            y = well * std::sinf(theta - p.t / 4);
+        }
+    };
+
+    template <> struct CurveShape<13> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(theta + p.t) * std::cosf(2 * theta + p.t / 2) * (1 + 0.2f * std::sinf(23 * theta));
+            y = p.r * std::cosf(theta - p.t) * std::sinf(3 * theta - p.t / 3) * (1 + 0.2f * std::cosf(19 * theta));
+        }
+    };
+
+    template <> struct CurveShape<14> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::powf(std::cosf(theta * p.param1), 2) * std::cosf(3 * theta + p.tFactor);
+            y = p.r * std::powf(std::sinf(theta * p.param2), 2) * std::sinf(2 * theta - p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<15> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float torus = p.r * (0.5f + 0.3f * std::sinf(theta * 4 + p.tFactor * 2));
+            x = torus * std::cosf(theta) + p.r / 3 * std::sinf(theta * 7 + p.tFactor);
+            y = torus * std::sinf(theta) - p.r / 3 * std::cosf(theta * 5 - p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<16> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float fib = p.r * (0.4f + 0.1f * std::fmodf(theta, kTwoPi) / M_PI);
+            x = fib * std::cosf(theta + p.tFactor) * (1 + 0.2f * std::sinf(13 * theta));
+            y = fib * std::sinf(theta - p.tFactor) * (1 + 0.2f * std::cosf(11 * theta));
+        }
+    };
+
+    template <> struct CurveShape<17> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * (std::cosf(theta * p.param1) + 0.3f * noise(theta * 10 + p.tFactor)) * std::cosf(theta + p.t / 5);
+            y = p.r * (std::sinf(theta * p.param2) + 0.3f * noise(theta * 12 - p.tFactor)) * std::sinf(theta - p.t / 7);
+        }
+    };
+
+    template <> struct CurveShape<18> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float nebula = p.r * (0.6f + 0.2f * std::powf(std::sinf(theta * 0.7f + p.tFactor * 0.3f), 3));
+            x = nebula * std::cosf(theta) * (1 + 0.4f * std::tanf(theta * 3 + p.tFactor * 0.5f));
+            y = nebula * std::sinf(theta) * (1 + 0.4f * std::tanf(theta * 4 - p.tFactor * 0.6f));
+        }
+    };
+
+    template <> struct CurveShape<19> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(theta * p.param1) * std::cosf(theta * p.param2 + p.tFactor) * (1 + 0.2f * std::sinf(17 * theta));
+            y = p.r * std::cosf(theta * p.param2) * std::sinf(theta * p.param1 - p.tFactor) * (1 + 0.2f * std::cosf(19 * theta));
+        }
+    };
+
+    template <> struct CurveShape<20> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::tanf(theta * 0.3f + p.tFactor * 0.2f) * std::cosf(theta * 2);
+            y = p.r * std::tanf(theta * 0.4f - p.tFactor * 0.3f) * std::sinf(theta * 1.5f);
+        }
+    };
+
+    template <> struct CurveShape<21> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float aurora = p.r * (0.7f + 0.1f * std::atanf(std::sinf(theta * 5 + p.tFactor * 2)));
+            x = aurora * std::cosf(theta + std::sinf(theta * 9 + p.tFactor));
+            y = aurora * std::sinf(theta - std::cosf(theta * 8 - p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<22> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float bloom = p.r * (0.4f + 0.3f * std::powf(std::sinf(theta * 0.5f + p.tFactor * 0.4f), 5));
+            x = bloom * std::cosf(theta) * (1 + 0.5f * std::sinf(23 * theta + p.tFactor * 3));
+            y = bloom * std::sinf(theta) * (1 + 0.5f * std::cosf(21 * theta - p.tFactor * 2));
+        }
+    };
+
+    template <> struct CurveShape<23> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::asinf(std::sinf(theta + p.tFactor)) * std::cosf(3 * theta);
+            y = p.r * std::acosf(std::cosf(theta - p.tFactor)) * std::sinf(2 * theta);
+        }
+    };
+
+    template <> struct CurveShape<24> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float star = p.r * (0.5f + 0.3f * std::sinf(theta * 5 + p.tFactor * 1.5f));
+            x = star * std::cosf(theta) * (1 + 0.3f * std::sinf(8 * theta + p.tFactor * 2));
+            y = star * std::sinf(theta) * (1 + 0.3f * std::cosf(8 * theta - p.tFactor * 2));
+        }
+    };
+
+    template <> struct CurveShape<25> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a = p.r * 0.6f, b = p.r * 0.2f;
+            x = (a + b) * std::cosf(theta) - b * std::cosf((a / b + 1) * theta + p.tFactor);
+            y = (a + b) * std::sinf(theta) - b * std::sinf((a / b + 1) * theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<26> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float c = p.r * 0.7f, d = p.r * 0.175f;
+            x = (c - d) * std::cosf(theta) + d * std::cosf((c / d - 1) * theta - p.tFactor);
+            y = (c - d) * std::sinf(theta) - d * std::sinf((c / d - 1) * theta - p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<27> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(3 * theta + p.tFactor * 0.8f) * std::cosf(theta * p.param1);
+            y = p.r * std::sinf(4 * theta - p.tFactor * 0.9f) * std::sinf(theta * p.param2);
+        }
+    };
+
+    template <> struct CurveShape<28> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float R = p.r * 0.6f, r2 = p.r * 0.3f;
+            x = (R + r2 * std::cosf(theta * 5 + p.tFactor)) * std::cosf(theta);
+            y = (R + r2 * std::sinf(theta * 5 + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<29> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float cat = p.r * (std::coshf(theta * 0.5f + p.tFactor * 0.5f) - 1);
+            x = cat * std::cosf(theta + p.tFactor * 0.3f);
+            y = cat * std::sinf(theta - p.tFactor * 0.3f);
+        }
+    };
+
+    template <> struct CurveShape<30> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * (std::cosf(theta + p.tFactor) + theta * std::sinf(theta + p.tFactor));
+            y = p.r * (std::sinf(theta + p.tFactor) - theta * std::cosf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<31> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float arch = p.r * (0.1f + 0.4f * (theta / kTwoPi + p.tFactor * 0.2f));
+            x = arch * std::cosf(theta);
+            y = arch * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<32> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float card = p.r * (1 + std::cosf(theta + p.tFactor * 0.7f));
+            x = card * std::cosf(theta);
+            y = card * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<33> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float lem = p.r * std::sqrtf(std::fabs(std::cosf(2 * theta + p.tFactor)));
+            x = lem * std::cosf(theta) * (1 + 0.2f * std::sinf(6 * theta + p.tFactor));
+            y = lem * std::sinf(theta) * (1 + 0.2f * std::cosf(6 * theta - p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<34> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * (2 * std::cosf(theta + p.tFactor) + std::cosf(2 * theta + p.tFactor * 2));
+            y = p.r * (2 * std::sinf(theta + p.tFactor) - std::sinf(2 * theta + p.tFactor * 2));
+        }
+    };
+
+    template <> struct CurveShape<35> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::powf(std::cosf(theta + p.tFactor), 3);
+            y = p.r * std::powf(std::sinf(theta + p.tFactor), 3);
+        }
+    };
+
+    template <> struct CurveShape<36> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float k = p.r * 0.5f;
+            x = k * (3 * std::cosf(theta) - std::cosf(3 * theta + p.tFactor));
+            y = k * (3 * std::sinf(theta) - std::sinf(3 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<37> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a1 = p.r * 0.7f, b1 = p.r * 0.5f;
+            x = (a1 * a1 - b1 * b1) * std::cosf(theta + p.tFactor) * std::cosf(theta) / a1;
+            y = (a1 * a1 - b1 * b1) * std::sinf(theta + p.tFactor) * std::sinf(theta) / b1;
+        }
+    };
+
+    template <> struct CurveShape<38> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float k1 = 0.1f + 0.05f * noise(p.tFactor);
+            x = p.r * std::expf(k1 * theta) * std::cosf(theta + p.tFactor * 0.5f);
+            y = p.r * std::expf(k1 * theta) * std::sinf(theta + p.tFactor * 0.5f);
+        }
+    };
+
+    template <> struct CurveShape<39> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float s = theta * 0.5f + p.tFactor;
+            x = p.r * 0.5f * std::cosf(s * s) * (1 + 0.2f * std::sinf(5 * theta + p.tFactor));
+            y = p.r * 0.5f * std::sinf(s * s) * (1 + 0.2f * std::cosf(5 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<40> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float tr = p.r * (1 + 0.2f * noise(theta + p.tFactor));
+            x = tr * (std::cosf(theta) + std::logf(std::tanf(theta / 2 + p.tFactor * 0.1f)));
+            y = tr * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<41> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float cis = p.r * std::sinf(theta) * std::sinf(theta + p.tFactor);
+            x = cis * std::cosf(theta) / (1 - std::sinf(theta + p.tFactor));
+            y = cis * std::sinf(theta) / (1 - std::sinf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<42> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float n = std::floor(p.param1 + 0.5f);
+            x = p.r * std::cosf(n * theta + p.tFactor) * std::cosf(theta);
+            y = p.r * std::cosf(n * theta + p.tFactor) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<43> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float theo = p.r * std::sqrtf(theta / M_PI + p.tFactor * 0.3f);
+            x = theo * std::cosf(theta);
+            y = theo * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<44> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a2 = p.r * 0.5f, b2 = p.r * 0.7f;
+            x = a2 * std::cosf(theta) + b2 * std::cosf(theta + p.tFactor) / std::cosf(theta);
+            y = a2 * std::sinf(theta) + b2 * std::sinf(theta + p.tFactor) / std::cosf(theta);
+        }
+    };
+
+    template <> struct CurveShape<45> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a3 = p.r * 0.5f;
+            x = a3 * (std::cosf(theta) - std::cosf(2 * theta + p.tFactor)) / std::sinf(theta);
+            y = a3 * (std::cosf(theta) + std::cosf(2 * theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<46> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a4 = p.r * 0.6f, b4 = p.r * 0.4f;
+            x = (a4 + b4 * std::cosf(theta + p.tFactor)) * std::cosf(theta);
+            y = (a4 + b4 * std::cosf(theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<47> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a5 = p.r * 0.5f;
+            x = a5 * (1 / std::cosf(theta) + std::cosf(theta + p.tFactor)) * std::cosf(theta);
+            y = a5 * (1 / std::cosf(theta) + std::cosf(theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<48> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a6 = p.r * 0.7f;
+            x = a6 * std::cosf(theta) / (1 + std::sinf(theta + p.tFactor));
+            y = a6 * std::cosf(theta) * std::sinf(theta + p.tFactor) / (1 + std::sinf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<49> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a7 = p.r * 0.6f, b7 = p.r * 0.3f;
+            x = a7 * (1 + std::sinf(theta + p.tFactor)) * std::cosf(theta);
+            y = b7 * (1 + std::sinf(theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<50> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a8 = p.r * 0.5f;
+            x = a8 * (std::powf(theta, 2) * std::cosf(theta + p.tFactor) - theta * std::sinf(theta));
+            y = a8 * (std::powf(theta, 2) * std::sinf(theta + p.tFactor) + theta * std::cosf(theta));
+        }
+    };
+
+    template <> struct CurveShape<51> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a9 = p.r * 0.5f, c9 = p.r * 0.7f;
+            float rho = std::sqrtf(std::powf(a9 * std::cosf(2 * theta + p.tFactor), 2) + c9 * c9);
+            x = rho * std::cosf(theta);
+            y = rho * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<52> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a10 = p.r * 0.6f, b10 = p.r * 0.4f;
+            float m = std::sqrtf(a10 * a10 - b10 * b10 * std::sinf(theta + p.tFactor) * std::sinf(theta + p.tFactor));
+            x = m * std::cosf(theta);
+            y = b10 * std::sinf(theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<53> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a11 = p.r * 0.5f;
+            x = a11 * theta * std::sinhf(theta + p.tFactor * 0.3f);
+            y = a11 * (std::coshf(theta + p.tFactor * 0.3f) - 1);
+        }
+    };
+
+    template <> struct CurveShape<54> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a12 = p.r * 0.6f;
+            x = a12 * std::sinf(theta + p.tFactor) * std::cosf(2 * theta + p.tFactor * 0.5f);
+            y = a12 * std::cosf(theta + p.tFactor) * std::sinf(2 * theta + p.tFactor * 0.5f);
+        }
+    };
+
+    template <> struct CurveShape<55> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a13 = p.r * 0.5f;
+            x = a13 * 3 * std::cosf(theta) / (1 + std::powf(std::sinf(theta + p.tFactor), 3));
+            y = a13 * 3 * std::cosf(theta) * std::sinf(theta + p.tFactor) / (1 + std::powf(std::sinf(theta + p.tFactor), 3));
+        }
+    };
+
+    template <> struct CurveShape<56> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a14 = p.r * 0.6f;
+            x = a14 * (2 * std::cosf(theta + p.tFactor) + 1) * std::cosf(theta);
+            y = a14 * (2 * std::cosf(theta + p.tFactor) + 1) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<57> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a15 = p.r * 0.5f;
+            x = a15 * std::cosf(theta) * (std::cosf(theta) - std::sinf(theta + p.tFactor)) / std::sinf(theta);
+            y = a15 * std::cosf(theta) * (std::cosf(theta) + std::sinf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<58> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a16 = p.r * 0.5f;
+            x = a16 * std::powf(theta, 2) * std::cosf(theta + p.tFactor);
+            y = a16 * std::powf(theta, 3) * std::sinf(theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<59> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a17 = p.r * 0.5f;
+            x = a17 * (3 * std::cosf(theta) - std::cosf(3 * theta + p.tFactor));
+            y = a17 * 3 * std::sinf(theta) * std::cosf(theta + p.tFactor) * std::cosf(theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<60> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a18 = p.r * 0.6f, b18 = p.r * 0.3f;
+            x = a18 * std::cosf(theta) + b18 * std::sinf(theta + p.tFactor) / std::cosf(theta);
+            y = a18 * std::sinf(theta) + b18 * std::cosf(theta + p.tFactor) / std::cosf(theta);
+        }
+    };
+
+    template <> struct CurveShape<61> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a19 = p.r * 0.5f;
+            x = a19 * std::cosf(theta) / (1 + std::powf(std::sinf(theta + p.tFactor), 2));
+            y = a19 * std::cosf(theta) * std::sinf(theta + p.tFactor) / (1 + std::powf(std::sinf(theta + p.tFactor), 2));
+        }
+    };
+
+    template <> struct CurveShape<62> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a20 = p.r * 0.5f;
+            x = a20 * (theta - std::sinf(theta + p.tFactor));
+            y = a20 * (1 - std::cosf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<63> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a21 = p.r * 0.6f, b21 = p.r * 0.4f;
+            float rho2 = std::sqrtf((std::powf(a21 * std::sinf(theta + p.tFactor), 2) - std::powf(b21 * std::cosf(theta), 2)) / (1 - 0.5f * std::sinf(theta + p.tFactor) * std::sinf(theta + p.tFactor)));
+            x = rho2 * std::cosf(theta);
+            y = rho2 * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<64> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a22 = p.r * 0.5f, n22 = std::floor(p.param1 + 0.5f);
+            x = a22 * std::powf(std::fabs(std::cosf(theta + p.tFactor)), 1.0f / n22) * std::cosf(theta);
+            y = a22 * std::powf(std::fabs(std::sinf(theta + p.tFactor)), 1.0f / n22) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<65> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a23 = p.r * 0.5f;
+            x = a23 * 2 * std::cosf(theta) * (1 + 0.2f * std::sinf(5 * theta + p.tFactor));
+            y = a23 * 2 / (1 + std::powf(std::tanf(theta + p.tFactor), 2));
+        }
+    };
+
+    template <> struct CurveShape<66> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a24 = p.r * 0.5f;
+            x = a24 * (theta + std::sinhf(theta + p.tFactor) * std::cosf(theta));
+            y = a24 * (std::coshf(theta + p.tFactor) - std::sinf(theta));
+        }
+    };
+
+    template <> struct CurveShape<67> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a25 = p.r * 0.6f;
+            x = a25 * (3 * std::cosf(theta + p.tFactor) - 1) * std::cosf(theta);
+            y = a25 * (3 * std::cosf(theta + p.tFactor) - 1) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<68> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a26 = p.r * 0.5f;
+            x = a26 * std::sqrtf(1 / (theta + p.tFactor + 0.1f)) * std::cosf(theta);
+            y = a26 * std::sqrtf(1 / (theta + p.tFactor + 0.1f)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<69> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a27 = p.r * 0.5f;
+            x = a27 * 2 * std::sinf(theta) * std::cosf(theta + p.tFactor) / (1 + std::powf(std::cosf(theta + p.tFactor), 2));
+            y = a27 * 2 * std::sinf(theta) * std::sinf(theta + p.tFactor) / (1 + std::powf(std::cosf(theta + p.tFactor), 2));
+        }
+    };
+
+    template <> struct CurveShape<70> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a28 = p.r * 0.5f;
+            x = a28 * std::cosf(theta) * (1 + 0.3f * noise(theta / 5 + p.tFactor));
+            y = a28 / (1 + std::powf(theta + p.tFactor, 2));
+        }
+    };
+
+    template <> struct CurveShape<71> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a29 = p.r * 0.6f, b29 = p.r * 0.2f, d29 = p.r * 0.3f;
+            x = (a29 + b29) * std::cosf(theta) - d29 * std::cosf((a29 / b29 + 1) * theta + p.tFactor);
+            y = (a29 + b29) * std::sinf(theta) - d29 * std::sinf((a29 / b29 + 1) * theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<72> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a30 = p.r * 0.7f, b30 = p.r * 0.2f, d30 = p.r * 0.25f;
+            x = (a30 - b30) * std::cosf(theta) + d30 * std::cosf((a30 / b30 - 1) * theta - p.tFactor);
+            y = (a30 - b30) * std::sinf(theta) - d30 * std::sinf((a30 / b30 - 1) * theta - p.tFactor);
+        }
+    };
+
+    // No shape of its own: a circle modulated by param1/param2, the 3D
+    // fallback point of the original dispatch seen from above
+    template <> struct CurveShape<73> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float phi = M_PI / 4.0f;
+            x = p.r * std::sinf(phi) * std::cosf(theta) + 0.3f * p.r * std::cosf(theta * p.param1 + p.tFactor);
+            y = p.r * std::sinf(phi) * std::sinf(theta) + 0.3f * p.r * std::sinf(theta * p.param2 - p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<74> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a32 = p.r * 0.5f;
+            x = a32 * std::sinf(theta + p.tFactor) / (1 + std::powf(std::cosf(theta), 2));
+            y = a32 * std::sinf(theta) * std::cosf(theta + p.tFactor) / (1 + std::powf(std::cosf(theta), 2));
+        }
+    };
+
+    template <> struct CurveShape<75> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a33 = p.r * 0.5f, b33 = p.r * 0.6f;
+            x = a33 * std::cosf(theta) + b33 * std::sinf(theta + p.tFactor) * std::cosf(theta);
+            y = a33 * std::sinf(theta) + b33 * std::sinf(theta + p.tFactor) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<76> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a34 = p.r * 0.5f;
+            x = a34 * (3 * std::cosf(theta) + std::cosf(3 * theta + p.tFactor));
+            y = a34 * (3 * std::sinf(theta) + std::sinf(3 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<77> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a35 = p.r * 0.5f;
+            x = a35 * std::cosf(theta / 3 + p.tFactor) * std::cosf(theta) * std::cosf(theta);
+            y = a35 * std::cosf(theta / 3 + p.tFactor) * std::sinf(theta) * std::cosf(theta);
+        }
+    };
+
+    template <> struct CurveShape<78> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a36 = p.r * 0.5f;
+            x = a36 * (1 / (theta + p.tFactor + 0.1f)) * std::cosf(theta);
+            y = a36 * (1 / (theta + p.tFactor + 0.1f)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<79> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a37 = p.r * 0.5f;
+            x = a37 * std::cosf(theta) / std::cosf(theta + p.tFactor);
+            y = a37 * std::tanf(theta + p.tFactor) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<80> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a38 = p.r * 0.5f;
+            x = a38 * std::cosf(theta) * (1 + std::sinf(4 * theta + p.tFactor));
+            y = a38 * std::sinf(theta) * (1 + std::sinf(4 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<81> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a39 = p.r * 0.6f, b39 = p.r * 0.3f;
+            float m2 = std::sqrtf(a39 * a39 + b39 * b39 * std::cosf(theta + p.tFactor) * std::cosf(theta + p.tFactor));
+            x = m2 * std::cosf(theta);
+            y = b39 * std::cosf(theta + p.tFactor);
+        }
+    };
+
+    template <> struct CurveShape<82> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a40 = p.r * 0.7f, b40 = p.r * 0.5f;
+            x = a40 * std::cosf(theta) * (1 + 0.2f * std::sinf(5 * theta + p.tFactor));
+            y = b40 * std::sinf(theta) * (1 + 0.2f * std::cosf(5 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<83> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a41 = p.r * 0.5f;
+            x = a41 * std::sinf(theta) * (std::expf(std::cosf(theta + p.tFactor)) - 2 * std::cosf(4 * theta) - std::powf(std::sinf(theta / 12), 5));
+            y = a41 * std::cosf(theta) * (std::expf(std::cosf(theta + p.tFactor)) - 2 * std::cosf(4 * theta) - std::powf(std::sinf(theta / 12), 5));
+        }
+    };
+
+    template <> struct CurveShape<84> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a42 = p.r * 0.5f;
+            x = a42 * (2 * std::cosf(theta + p.tFactor) + std::cosf(2 * theta + p.tFactor));
+            y = a42 * (2 * std::sinf(theta + p.tFactor) - std::sinf(2 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<85> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a43 = p.r * 0.5f;
+            x = a43 * std::sinf(theta + p.tFactor) / (theta + p.tFactor + 0.1f);
+            y = a43 * std::cosf(theta) / (theta + p.tFactor + 0.1f);
+        }
+    };
+
+    template <> struct CurveShape<86> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a44 = p.r * 0.5f;
+            x = a44 * (theta / M_PI) * std::sinf(theta + p.tFactor);
+            y = a44 * std::cosf(theta) / (theta / M_PI + p.tFactor + 0.1f);
+        }
+    };
+
+    template <> struct CurveShape<87> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a45 = p.r * 0.5f, n45 = std::floor(p.param2 + 0.5f);
+            x = a45 * std::powf(std::fabs(std::cosf(theta + p.tFactor)), 2.0f / n45) * std::cosf(theta);
+            y = a45 * std::powf(std::fabs(std::sinf(theta + p.tFactor)), 2.0f / n45) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<88> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            x = p.r * std::sinf(5 * theta + p.tFactor * 0.7f) * std::cosf(theta * p.param1);
+            y = p.r * std::sinf(6 * theta - p.tFactor * 0.8f) * std::sinf(theta * p.param2);
+        }
+    };
+
+    template <> struct CurveShape<89> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a46 = p.r * 0.5f, n46 = std::floor(p.param1 + 0.5f);
+            float k46 = n46 * theta + p.tFactor;
+            x = a46 * std::sinf(n46 * k46) * std::cosf(k46);
+            y = a46 * std::sinf(n46 * k46) * std::sinf(k46);
+        }
+    };
+
+    template <> struct CurveShape<90> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float s2 = theta * 0.4f + p.tFactor;
+            x = p.r * 0.4f * std::cosf(s2 * s2 + p.tFactor) * (1 + 0.3f * std::sinf(6 * theta));
+            y = p.r * 0.4f * std::sinf(s2 * s2 + p.tFactor) * (1 + 0.3f * std::cosf(6 * theta));
+        }
+    };
+
+    template <> struct CurveShape<91> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a47 = p.r * 0.5f;
+            x = a47 * (theta - std::sinf(theta + p.tFactor) + 0.2f * std::sinf(5 * theta));
+            y = a47 * (1 - std::cosf(theta + p.tFactor) + 0.2f * std::cosf(5 * theta));
+        }
+    };
+
+    template <> struct CurveShape<92> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a48 = p.r * 0.5f;
+            x = a48 * (1 + std::sinf(theta + p.tFactor)) * std::cosf(theta);
+            y = a48 * (1 + std::sinf(theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<93> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a49 = p.r * 0.5f;
+            x = a49 * std::powf(std::cosf(theta + p.tFactor), 5) * std::cosf(theta);
+            y = a49 * std::powf(std::sinf(theta + p.tFactor), 5) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<94> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a50 = p.r * 0.5f;
+            x = a50 * (2 * std::cosf(theta + p.tFactor) - std::cosf(2 * theta + p.tFactor * 1.5f));
+            y = a50 * (2 * std::sinf(theta + p.tFactor) + std::sinf(2 * theta + p.tFactor * 1.5f));
+        }
+    };
+
+    template <> struct CurveShape<95> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a51 = p.r * 0.5f;
+            x = a51 * (3 * std::cosf(theta) - std::cosf(5 * theta + p.tFactor));
+            y = a51 * (3 * std::sinf(theta) - std::sinf(5 * theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<96> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a52 = p.r * 0.6f, b52 = p.r * 0.4f;
+            x = a52 * (1 + std::cosf(theta + p.tFactor)) * std::cosf(theta);
+            y = b52 * (1 + std::cosf(theta + p.tFactor)) * std::sinf(theta);
+        }
+    };
+
+    template <> struct CurveShape<97> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a53 = p.r * 0.5f;
+            x = a53 * 3 * std::sinf(theta) * std::cosf(theta + p.tFactor) / (1 + std::sinf(theta + p.tFactor));
+            y = a53 * 3 * std::sinf(theta) * std::sinf(theta + p.tFactor) / (1 + std::sinf(theta + p.tFactor));
+        }
+    };
+
+    template <> struct CurveShape<98> {
+        static void eval(const CurveParams& p, float theta, float& x, float& y) {
+            float a54 = p.r * 0.5f;
+            x = a54 * (std::cosf(theta) + std::logf(std::tanf(theta / 2 + p.tFactor * 0.2f)));
+            y = a54 * std::sinf(theta) * (1 + 0.2f * std::sinf(5 * theta + p.tFactor));
+        }
+    };
+
+    template <int N>
+    void curveBatch(const CurveParams& params, const float* theta, float* x, float* y, int count) {
+        // A local copy: stores to x and y can't alias it, so terms that
+        // depend only on the parameters stay out of the loop
+        const CurveParams p = params;
+        for (int i = 0; i < count; i++) {
+            float px, py;
+            CurveShape<N>::eval(p, theta[i], px, py);
+            x[i] = px;
+            y[i] = py;
+        }
+    }
+
+    template <int... N>
+    std::array<CurveBatchKernel, sizeof...(N)> makeKernelTable(std::integer_sequence<int, N...>) {
+        return {{ &curveBatch<N>... }};
+    }
+}
+
+CurveParams makeCurveParams(int type, float r, float t, float slowTime, float param1, float param2) {
+    CurveParams p;
+    p.r = r;
+    p.t = t;
+    p.n3 = 0.5f + noise(slowTime / 10.0f + type * 2.0f);
+    p.tFactor = slowTime * (0.8f + 0.2f * noise(slowTime / 15.0f + type));
+    p.param1 = param1;
+    p.param2 = param2;
+    p.bass = 0.0f;
+    p.mid = 0.0f;
+    p.treble = 0.0f;
+    p.amplitude = 0.0f;
+    p.beat = 0.0f;
+    return p;
+}
+
+CurveBatchKernel curveKernel(int type) {
+    static const std::array<CurveBatchKernel, kCurveTypeCount> kCurveKernels =
+        makeKernelTable(std::make_integer_sequence<int, kCurveTypeCount>());
+    CurveBatchKernel script = curveScriptKernel(type - kCurveTypeCount);
+    if (script) return script;
+    int index = type % kCurveTypeCount;
+    if (index < 0) index += kCurveTypeCount;
+    return kCurveKernels[index];
+}
+
+int sanitizeCurvePoints(float* x, float* y, int count, float limit) {
+    int changed = 0;
+    int leading = 0;    // NaN points before the first finite one, filled in once it is found
+
+    auto keep = [&](int i) {
+        for (int j = 0; j < leading; j++) {
+            x[j] = x[i];
+            y[j] = y[i];
+        }
+        leading = -1;
+    };
+    auto fixPoint = [&](int i) {
+        if (std::isnan(x[i]) || std::isnan(y[i])) {
+            changed++;
+            if (leading >= 0) {
+                leading++;
+            }
+            else {
+                x[i] = x[i - 1];
+                y[i] = y[i - 1];
+            }
+            return;
+        }
+        float cx = (std::min)((std::max)(x[i], -limit), limit);
+        float cy = (std::min)((std::max)(y[i], -limit), limit);
+        if (cx != x[i] || cy != y[i]) changed++;
+        x[i] = cx;
+        y[i] = cy;
+        if (leading >= 0) keep(i);
+    };
+
+    int i = 0;
+#ifdef CURVE_KERNELS_USE_SSE2
+    // Clamping is branch free; a block with a NaN in it (rare) goes through
+    // the scalar path, which needs the points in order
+    const __m128 high = _mm_set1_ps(limit);
+    const __m128 low = _mm_set1_ps(-limit);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 nan = _mm_or_ps(_mm_cmpunord_ps(vx, vx), _mm_cmpunord_ps(vy, vy));
+        if (_mm_movemask_ps(nan)) {
+            for (int j = i; j < i + 4; j++) fixPoint(j);
+            continue;
+        }
+        __m128 cx = _mm_min_ps(_mm_max_ps(vx, low), high);
+        __m128 cy = _mm_min_ps(_mm_max_ps(vy, low), high);
+        int moved = _mm_movemask_ps(_mm_or_ps(_mm_cmpneq_ps(cx, vx), _mm_cmpneq_ps(cy, vy)));
+        if (moved) {
+            changed += (moved & 1) + ((moved >> 1) & 1) + ((moved >> 2) & 1) + ((moved >> 3) & 1);
+        }
+        _mm_storeu_ps(x + i, cx);
+        _mm_storeu_ps(y + i, cy);
+        if (leading >= 0) keep(i);
+    }
+#endif
+    for (; i < count; i++) {
+        fixPoint(i);
+    }
+
+    // Nothing finite at all: collapse onto the center
+    for (int j = 0; j < leading; j++) {
+        x[j] = 0.0f;
+        y[j] = 0.0f;
+    }
+    return changed;
+}
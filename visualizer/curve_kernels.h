@@ -0,0 +1,40 @@
+#ifndef CURVE_KERNELS_H
+#define CURVE_KERNELS_H
+
+// Everything a curve shape needs besides theta. Fixed for all points of one
+// curve, so it is worked out once per curve instead of once per point.
+struct CurveParams {
+    float r;         // radius the shape is scaled to
+    float t;         // animation time, seconds
+    float tFactor;   // slow per-type phase
+    float n3;        // per-type frequency jitter
+    float param1;
+    float param2;
+    // Audio features, only read by scripted curves (0 unless set)
+    float bass;
+    float mid;
+    float treble;
+    float amplitude;
+    float beat;
+};
+
+// Distinct built-in curve shapes. Loaded scripts follow as the next types
+// (see curve_script.h); other type numbers wrap around.
+const int kCurveTypeCount = 99;
+
+// Evaluates one shape for `count` angles into separate x and y arrays
+typedef void (*CurveBatchKernel)(const CurveParams& p, const float* theta, float* x, float* y, int count);
+
+// `slowTime` drives the per-type jitter terms (tFactor, n3)
+CurveParams makeCurveParams(int type, float r, float t, float slowTime, float param1, float param2);
+CurveBatchKernel curveKernel(int type);
+
+// Makes a batch of kernel output safe to draw. Some shapes have poles
+// (tan, log of 0, division by a cosine) where points come out as Inf or
+// NaN, and those are floating point values, not exceptions. Coordinates
+// are clamped to +-limit and a point with a NaN takes the position of the
+// point before it (the first finite one for a leading run), so the curve
+// pauses there instead of jumping. Returns the number of points changed.
+int sanitizeCurvePoints(float* x, float* y, int count, float limit);
+
+#endif // CURVE_KERNELS_H
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cmath>
+#include "curve_morph.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CURVE_MORPH_USE_SSE2 1
+#endif
+
+namespace {
+    const float kFourTurns = 8.0f * static_cast<float>(M_PI);
+    const float kTimeQuantum = 1.0f / 64.0f;    // seconds; well under a frame of visible motion
+    const float kParamQuantum = 1.0f / 64.0f;
+    const float kAudioQuantum = 1.0f / 64.0f;   // the features are smoothed levels around 0..1
+    const int kArcOversample = 8;               // dense samples per output point
+    const float kArcClamp = 4.0f;               // radii; poles are cut off-screen before measuring
+
+    int quantize(float value, float quantum) {
+        return static_cast<int>(std::floor(value / quantum + 0.5f));
+    }
+}
+
+CurveShapeCache::CurveShapeCache(float slowTime, size_t capacity) : slowTime(slowTime),
+capacity((std::max)(capacity, (size_t)2)), clock(0), hitCount(0), missCount(0) {
+    entries.reserve(this->capacity);
+}
+
+void CurveShapeCache::clear() {
+    entries.clear();
+}
+
+void CurveShapeCache::sample(const Key& key, CurveSampleSet& points) {
+    CurveParams params = makeCurveParams(key.type, 1.0f, key.timeStep * kTimeQuantum, slowTime,
+        key.param1Step * kParamQuantum, key.param2Step * kParamQuantum);
+    params.bass = key.bassStep * kAudioQuantum;
+    params.mid = key.midStep * kAudioQuantum;
+    params.treble = key.trebleStep * kAudioQuantum;
+    params.amplitude = key.amplitudeStep * kAudioQuantum;
+    params.beat = key.beatStep * kAudioQuantum;
+    CurveBatchKernel kernel = curveKernel(key.type);
+    const int count = key.resolution;
+    points.x.resize(count);
+    points.y.resize(count);
+
+    if (!key.arcLength) {
+        denseTheta.resize(count);
+        for (int i = 0; i < count; i++) {
+            denseTheta[i] = kFourTurns * i / (count - 1);
+        }
+        kernel(params, denseTheta.data(), points.x.data(), points.y.data(), count);
+        sanitizeCurvePoints(points.x.data(), points.y.data(), count, kArcClamp);
+        return;
+    }
+
+    const int dense = (count - 1) * kArcOversample + 1;
+    denseTheta.resize(dense);
+    denseX.resize(dense);
+    denseY.resize(dense);
+    arc.resize(dense);
+    for (int i = 0; i < dense; i++) {
+        denseTheta[i] = kFourTurns * i / (dense - 1);
+    }
+    kernel(params, denseTheta.data(), denseX.data(), denseY.data(), dense);
+
+    // Excursions to a pole would take up all of the length otherwise
+    sanitizeCurvePoints(denseX.data(), denseY.data(), dense, kArcClamp);
+    for (int i = 0; i < dense; i++) {
+        float dx = i > 0 ? denseX[i] - denseX[i - 1] : 0.0f;
+        float dy = i > 0 ? denseY[i] - denseY[i - 1] : 0.0f;
+        arc[i] = (i > 0 ? arc[i - 1] : 0.0f) + std::sqrt(dx * dx + dy * dy);
+    }
+
+    const float total = arc[dense - 1];
+    for (int j = 0, k = 0; j < count; j++) {
+        float s = total > 0.0f ? total * j / (count - 1) : 0.0f;
+        if (total <= 0.0f) k = (std::min)(j * kArcOversample, dense - 2);
+        while (k < dense - 2 && arc[k + 1] < s) k++;
+        float length = arc[k + 1] - arc[k];
+        float u = length > 0.0f ? (std::min)((s - arc[k]) / length, 1.0f) : 0.0f;
+        points.x[j] = denseX[k] + (denseX[k + 1] - denseX[k]) * u;
+        points.y[j] = denseY[k] + (denseY[k + 1] - denseY[k]) * u;
+    }
+}
+
+const CurveSampleSet& CurveShapeCache::get(int type, int resolution, float t, float param1, float param2,
+    const CurveAudio& audio, bool arcLength) {
+    const Key key = { type, (std::max)(resolution, 2), arcLength, quantize(t, kTimeQuantum),
+        quantize(param1, kParamQuantum), quantize(param2, kParamQuantum),
+        quantize(audio.bass, kAudioQuantum), quantize(audio.mid, kAudioQuantum), quantize(audio.treble, kAudioQuantum),
+        quantize(audio.amplitude, kAudioQuantum), quantize(audio.beat, kAudioQuantum) };
+    clock++;
+
+    for (auto& entry : entries) {
+        if (entry.key == key) {
+            entry.lastUsed = clock;
+            hitCount++;
+            return entry.points;
+        }
+    }
+
+    missCount++;
+    Entry* slot;
+    if (entries.size() < capacity) {
+        entries.push_back(Entry());
+        slot = &entries.back();
+    }
+    else {
+        slot = &*std::min_element(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    }
+    slot->key = key;
+    slot->lastUsed = clock;
+    sample(key, slot->points);
+    return slot->points;
+}
+
+void lerpCurves(const float* ax, const float* ay, const float* bx, const float* by, float weight, float scale,
+    float* x, float* y, int count) {
+    // (a + (b - a) * w) * s  ==  a * (1 - w) * s + b * w * s
+    const float wa = (1.0f - weight) * scale;
+    const float wb = weight * scale;
+    int i = 0;
+#ifdef CURVE_MORPH_USE_SSE2
+    const __m128 va = _mm_set1_ps(wa);
+    const __m128 vb = _mm_set1_ps(wb);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ax + i), va), _mm_mul_ps(_mm_loadu_ps(bx + i), vb)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ay + i), va), _mm_mul_ps(_mm_loadu_ps(by + i), vb)));
+    }
+#endif
+    for (; i < count; i++) {
+        x[i] = ax[i] * wa + bx[i] * wb;
+        y[i] = ay[i] * wa + by[i] * wb;
+    }
+}
+
+CurveMorph::CurveMorph(float slowTime, int resolution) : cache(slowTime), resolution(resolution),
+arcLength(true), active(false), fromType(0), toType(0), fromTime(0.0f), toTime(0.0f), param1(0.0f),
+param2(0.0f), audio(), elapsed(0.0f), duration(1.0f) {
+}
+
+void CurveMorph::start(int from, int to, float now, float seconds, float newParam1, float newParam2,
+    const CurveAudio& newAudio) {
+    fromType = from;
+    toType = to;
+    duration = (std::max)(seconds, 0.01f);
+    fromTime = now;
+    toTime = now + duration;
+    param1 = newParam1;
+    param2 = newParam2;
+    audio = newAudio;
+    elapsed = 0.0f;
+    active = true;
+}
+
+void CurveMorph::update(float deltaTime) {
+    if (!active) return;
+    elapsed += deltaTime;
+    if (elapsed >= duration) active = false;
+}
+
+float CurveMorph::getWeight() const {
+    float u = (std::min)(elapsed / duration, 1.0f);
+    return u * u * (3.0f - 2.0f * u);
+}
+
+int CurveMorph::evaluate(float r, std::vector<float>& x, std::vector<float>& y) {
+    const CurveSampleSet& a = cache.get(fromType, resolution, fromTime, param1, param2, audio, arcLength);
+    const CurveSampleSet& b = cache.get(toType, resolution, toTime, param1, param2, audio, arcLength);
+    x.resize(resolution);
+    y.resize(resolution);
+    lerpCurves(a.x.data(), a.y.data(), b.x.data(), b.y.data(), getWeight(), r, x.data(), y.data(), resolution);
+    return resolution;
+}
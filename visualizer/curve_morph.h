@@ -0,0 +1,140 @@
+#ifndef CURVE_MORPH_H
+#define CURVE_MORPH_H
+
+#include <vector>
+#include "curve_kernels.h"
+
+// One curve shape sampled at r = 1, x and y in separate arrays. Every shape
+// is linear in r, so a cached set is scaled to the current size while it
+// is being interpolated.
+struct CurveSampleSet {
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+// Audio features the scripted curves read, as in CurveParams
+struct CurveAudio {
+    float bass;
+    float mid;
+    float treble;
+    float amplitude;
+    float beat;
+};
+
+// Recently sampled shapes, keyed by (type, resolution, parameterization,
+// quantized time, params and audio). The quantized values are also what the
+// shape is sampled with, so a hit is exactly the set a miss would produce.
+// Least recently used entries are overwritten in place: a returned set
+// stays valid until `capacity` other keys have been requested.
+class CurveShapeCache {
+private:
+    struct Key {
+        int type;
+        int resolution;
+        bool arcLength;
+        int timeStep;
+        int param1Step;
+        int param2Step;
+        int bassStep;
+        int midStep;
+        int trebleStep;
+        int amplitudeStep;
+        int beatStep;
+
+        bool operator==(const Key& other) const {
+            return type == other.type && resolution == other.resolution && arcLength == other.arcLength &&
+                timeStep == other.timeStep && param1Step == other.param1Step && param2Step == other.param2Step &&
+                bassStep == other.bassStep && midStep == other.midStep && trebleStep == other.trebleStep &&
+                amplitudeStep == other.amplitudeStep && beatStep == other.beatStep;
+        }
+    };
+
+    struct Entry {
+        Key key;
+        CurveSampleSet points;
+        unsigned int lastUsed;
+    };
+
+    float slowTime;
+    size_t capacity;
+    std::vector<Entry> entries;
+    unsigned int clock;
+    unsigned int hitCount;
+    unsigned int missCount;
+
+    // Dense scratch for the arc-length resampling
+    std::vector<float> denseTheta;
+    std::vector<float> denseX;
+    std::vector<float> denseY;
+    std::vector<float> arc;
+
+    void sample(const Key& key, CurveSampleSet& points);
+
+public:
+    // `slowTime` as passed to makeCurveParams
+    CurveShapeCache(float slowTime, size_t capacity = 8);
+
+    // The shape sampled at `resolution` points over four turns, either
+    // evenly in theta or evenly along its length
+    const CurveSampleSet& get(int type, int resolution, float t, float param1, float param2,
+        const CurveAudio& audio, bool arcLength);
+    void clear();
+
+    unsigned int getHitCount() const { return hitCount; }
+    unsigned int getMissCount() const { return missCount; }
+};
+
+// x/y = lerp(a, b, weight) * scale, for `count` points
+void lerpCurves(const float* ax, const float* ay, const float* bx, const float* by, float weight, float scale,
+    float* x, float* y, int count);
+
+// Timed transition from one curve type to another. Both ends are frozen
+// for the length of the morph: the source at its pose when the morph
+// starts, the target at the pose it will have when the morph ends, so the
+// curve leaves the live source and arrives at the live target without a
+// jump. Both are sampled with the audio at the start; scripted curves that
+// react to it only move as far as the smoothed audio does over the morph.
+// Per frame that is two cache lookups and a lerp.
+class CurveMorph {
+private:
+    CurveShapeCache cache;
+    int resolution;
+    bool arcLength;
+    bool active;
+    int fromType;
+    int toType;
+    float fromTime;
+    float toTime;
+    float param1;
+    float param2;
+    CurveAudio audio;
+    float elapsed;
+    float duration;
+
+public:
+    CurveMorph(float slowTime, int resolution = 512);
+
+    // Matching points along the length instead of by angle keeps curves
+    // of very different speed from folding over themselves mid-morph
+    void setArcLength(bool enable) { arcLength = enable; }
+    bool getArcLength() const { return arcLength; }
+
+    // `now` is the curve animation time the morph starts at
+    void start(int from, int to, float now, float seconds, float param1, float param2, const CurveAudio& audio);
+    void update(float deltaTime);
+    bool isActive() const { return active; }
+    int getFromType() const { return fromType; }
+    int getToType() const { return toType; }
+
+    // Eased 0..1 progress
+    float getWeight() const;
+
+    // Writes the in-between shape scaled to `r`, returns the point count
+    int evaluate(float r, std::vector<float>& x, std::vector<float>& y);
+
+    const CurveShapeCache& getCache() const { return cache; }
+    // After the shapes behind some types changed (scripts reloaded)
+    void clearCache() { cache.clear(); }
+};
+
+#endif // CURVE_MORPH_H
@@ -0,0 +1,598 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <utility>
+#include "curve_script.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Declare writeDebugLog as extern to use the implementation from engine.cpp
+extern void writeDebugLog(const std::string& message);
+
+namespace {
+    const int kBlock = 128;          // points per pass over the varying code
+    const int kMaxRegisters = 24;    // varying registers, kBlock floats each
+    const int kMaxScalars = 256;
+
+    // Scalar slots filled from CurveParams before every run, in this order
+    const char* const kInputNames[] = {
+        "r", "t", "tfactor", "n3", "param1", "param2", "bass", "mid", "treble", "amplitude", "beat"
+    };
+    const int kInputCount = sizeof(kInputNames) / sizeof(kInputNames[0]);
+
+    inline float fract(float v) {
+        return v - std::floor(v);
+    }
+
+    // Same as the built-in shapes' noise(x)
+    inline float noise(float v) {
+        return fract(std::sin(v * 12.9898f));
+    }
+
+    template <typename F>
+    inline void unaryLoop(F f, float* d, const float* a, int n) {
+        for (int i = 0; i < n; i++) d[i] = f(a[i]);
+    }
+
+    template <typename F>
+    inline void binaryLoop(F f, unsigned char varying, float* d, const float* a, float sa, const float* b, float sb,
+        int n) {
+        if (varying == 3) {
+            for (int i = 0; i < n; i++) d[i] = f(a[i], b[i]);
+        }
+        else if (varying == 1) {
+            for (int i = 0; i < n; i++) d[i] = f(a[i], sb);
+        }
+        else {
+            for (int i = 0; i < n; i++) d[i] = f(sa, b[i]);
+        }
+    }
+
+    std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return std::string();
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    std::string stripComment(const std::string& line) {
+        return trim(line.substr(0, line.find('#')));
+    }
+}
+
+// Recursive descent over one expression, emitting code as it goes
+struct CurveProgram::Parser {
+    CurveProgram& program;
+    const std::map<std::string, Operand>& locals;
+    const std::string& text;
+    size_t pos;
+    std::string error;
+
+    Parser(CurveProgram& program, const std::map<std::string, Operand>& locals, const std::string& text) :
+    program(program), locals(locals), text(text), pos(0) {
+    }
+
+    bool fail(const std::string& message) {
+        if (error.empty()) error = message;
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return pos >= text.size();
+    }
+
+    bool identifier(std::string& out) {
+        skipSpace();
+        size_t start = pos;
+        while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) pos++;
+        if (pos == start || std::isdigit(static_cast<unsigned char>(text[start]))) {
+            pos = start;
+            return false;
+        }
+        out = text.substr(start, pos - start);
+        return true;
+    }
+
+    bool expression(Operand& out) {
+        if (!term(out)) return false;
+        for (;;) {
+            Op op;
+            if (accept('+')) op = Op::Add;
+            else if (accept('-')) op = Op::Sub;
+            else return true;
+            Operand rhs;
+            if (!term(rhs)) return false;
+            out = program.emit(op, out, rhs);
+        }
+    }
+
+    bool term(Operand& out) {
+        if (!unary(out)) return false;
+        for (;;) {
+            Op op;
+            if (accept('*')) op = Op::Mul;
+            else if (accept('/')) op = Op::Div;
+            else return true;
+            Operand rhs;
+            if (!unary(rhs)) return false;
+            out = program.emit(op, out, rhs);
+        }
+    }
+
+    // -a^b is -(a^b), a^b^c is a^(b^c)
+    bool unary(Operand& out) {
+        if (accept('-')) {
+            if (!unary(out)) return false;
+            out = program.emit(Op::Neg, out, out);
+            return true;
+        }
+        if (accept('+')) return unary(out);
+        if (!primary(out)) return false;
+        if (accept('^')) {
+            Operand exponent;
+            if (!unary(exponent)) return false;
+            out = program.emit(Op::Pow, out, exponent);
+        }
+        return true;
+    }
+
+    bool primary(Operand& out) {
+        skipSpace();
+        if (accept('(')) {
+            if (!expression(out)) return false;
+            return accept(')') || fail("missing ')'");
+        }
+
+        if (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.')) {
+            const char* begin = text.c_str() + pos;
+            char* end;
+            float value = std::strtof(begin, &end);
+            if (end == begin) return fail("bad number");
+            pos += end - begin;
+            out = program.constant(value);
+            return true;
+        }
+
+        std::string name;
+        if (!identifier(name)) {
+            return fail(pos < text.size() ? "unexpected '" + text.substr(pos, 1) + "'" : "expression ends early");
+        }
+
+        if (accept('(')) {
+            Op op;
+            int arity;
+            if (!lookupFunction(name, op, arity)) return fail("unknown function '" + name + "'");
+            Operand args[2];
+            for (int i = 0; i < arity; i++) {
+                if (i > 0 && !accept(',')) return fail(name + "() takes " + std::to_string(arity) + " arguments");
+                if (!expression(args[i])) return false;
+            }
+            if (!accept(')')) {
+                return fail(accept(',') ? name + "() takes " + std::to_string(arity) + " argument(s)" :
+                    "missing ')' after " + name + "(");
+            }
+            out = program.emit(op, args[0], arity > 1 ? args[1] : args[0]);
+            return true;
+        }
+
+        if (name == "theta") {
+            out.kind = Kind::Varying;
+            out.index = 0;
+            out.value = 0.0f;
+            return true;
+        }
+        if (name == "pi") {
+            out = program.constant(static_cast<float>(M_PI));
+            return true;
+        }
+        for (int i = 0; i < kInputCount; i++) {
+            if (name == kInputNames[i]) {
+                out.kind = Kind::Uniform;
+                out.index = i;
+                out.value = 0.0f;
+                return true;
+            }
+        }
+        auto local = locals.find(name);
+        if (local == locals.end()) return fail("unknown name '" + name + "'");
+        out = local->second;
+        return true;
+    }
+};
+
+CurveProgram::CurveProgram() : scalarCount(kInputCount), registerCount(1), virtualCount(1) {
+    scalarInit.assign(kInputCount, 0.0f);
+    outX = constant(0.0f);
+    outY = outX;
+}
+
+bool CurveProgram::lookupFunction(const std::string& function, Op& op, int& arity) {
+    static const std::map<std::string, std::pair<Op, int>> kFunctions = {
+        { "sin", { Op::Sin, 1 } }, { "cos", { Op::Cos, 1 } }, { "tan", { Op::Tan, 1 } },
+        { "asin", { Op::Asin, 1 } }, { "acos", { Op::Acos, 1 } }, { "atan", { Op::Atan, 1 } },
+        { "atan2", { Op::Atan2, 2 } }, { "sinh", { Op::Sinh, 1 } }, { "cosh", { Op::Cosh, 1 } },
+        { "tanh", { Op::Tanh, 1 } }, { "exp", { Op::Exp, 1 } }, { "log", { Op::Log, 1 } },
+        { "sqrt", { Op::Sqrt, 1 } }, { "abs", { Op::Abs, 1 } }, { "floor", { Op::Floor, 1 } },
+        { "fract", { Op::Fract, 1 } }, { "mod", { Op::Mod, 2 } }, { "min", { Op::Min, 2 } },
+        { "max", { Op::Max, 2 } }, { "pow", { Op::Pow, 2 } }, { "noise", { Op::Noise, 1 } }
+    };
+    auto found = kFunctions.find(function);
+    if (found == kFunctions.end()) return false;
+    op = found->second.first;
+    arity = found->second.second;
+    return true;
+}
+
+float CurveProgram::apply(Op op, float a, float b) {
+    switch (op) {
+    case Op::Add: return a + b;
+    case Op::Sub: return a - b;
+    case Op::Mul: return a * b;
+    case Op::Div: return a / b;
+    case Op::Pow: return std::pow(a, b);
+    case Op::Neg: return -a;
+    case Op::Sin: return std::sin(a);
+    case Op::Cos: return std::cos(a);
+    case Op::Tan: return std::tan(a);
+    case Op::Asin: return std::asin(a);
+    case Op::Acos: return std::acos(a);
+    case Op::Atan: return std::atan(a);
+    case Op::Atan2: return std::atan2(a, b);
+    case Op::Sinh: return std::sinh(a);
+    case Op::Cosh: return std::cosh(a);
+    case Op::Tanh: return std::tanh(a);
+    case Op::Exp: return std::exp(a);
+    case Op::Log: return std::log(a);
+    case Op::Sqrt: return std::sqrt(a);
+    case Op::Abs: return std::fabs(a);
+    case Op::Floor: return std::floor(a);
+    case Op::Fract: return fract(a);
+    case Op::Mod: return std::fmod(a, b);
+    case Op::Min: return (std::min)(a, b);
+    case Op::Max: return (std::max)(a, b);
+    case Op::Noise: return noise(a);
+    }
+    return 0.0f;
+}
+
+CurveProgram::Operand CurveProgram::constant(float value) {
+    for (int i = kInputCount; i < static_cast<int>(scalarInit.size()); i++) {
+        if (scalarInit[i] == value && std::signbit(scalarInit[i]) == std::signbit(value)) {
+            Operand operand = { Kind::Constant, i, value };
+            return operand;
+        }
+    }
+    scalarInit.push_back(value);
+    Operand operand = { Kind::Constant, scalarCount++, value };
+    return operand;
+}
+
+CurveProgram::Operand CurveProgram::emit(Op op, Operand a, Operand b) {
+    const bool unary = op != Op::Add && op != Op::Sub && op != Op::Mul && op != Op::Div && op != Op::Pow &&
+        op != Op::Atan2 && op != Op::Mod && op != Op::Min && op != Op::Max;
+    if (unary) b = a;
+
+    if (a.kind == Kind::Constant && b.kind == Kind::Constant) {
+        return constant(apply(op, a.value, b.value));
+    }
+
+    Instruction instruction = { op, 0, 0, a.index, b.index };
+    if (a.kind == Kind::Varying) instruction.varying |= 1;
+    if (!unary && b.kind == Kind::Varying) instruction.varying |= 2;
+
+    Operand result;
+    result.value = 0.0f;
+    if (instruction.varying == 0) {
+        instruction.dst = scalarCount++;
+        scalarInit.push_back(0.0f);
+        uniformCode.push_back(instruction);
+        result.kind = Kind::Uniform;
+    }
+    else {
+        instruction.dst = virtualCount++;
+        varyingCode.push_back(instruction);
+        result.kind = Kind::Varying;
+    }
+    result.index = instruction.dst;
+    return result;
+}
+
+bool CurveProgram::allocateRegisters(std::string& error) {
+    // Drop varying code no output depends on (unused locals)
+    std::vector<unsigned char> live(virtualCount, 0);
+    if (outX.kind == Kind::Varying) live[outX.index] = 1;
+    if (outY.kind == Kind::Varying) live[outY.index] = 1;
+    std::vector<Instruction> kept;
+    for (size_t k = varyingCode.size(); k-- > 0;) {
+        const Instruction& instruction = varyingCode[k];
+        if (!live[instruction.dst]) continue;
+        if (instruction.varying & 1) live[instruction.a] = 1;
+        if (instruction.varying & 2) live[instruction.b] = 1;
+        kept.push_back(instruction);
+    }
+    varyingCode.assign(kept.rbegin(), kept.rend());
+
+    // Linear scan: a register is free again after its value's last read.
+    // Operations are elementwise, so the destination may reuse an operand's
+    // register within the same instruction.
+    const int end = static_cast<int>(varyingCode.size());
+    std::vector<int> lastUse(virtualCount, -1);
+    for (int k = 0; k < end; k++) {
+        if (varyingCode[k].varying & 1) lastUse[varyingCode[k].a] = k;
+        if (varyingCode[k].varying & 2) lastUse[varyingCode[k].b] = k;
+    }
+    if (outX.kind == Kind::Varying) lastUse[outX.index] = end;
+    if (outY.kind == Kind::Varying) lastUse[outY.index] = end;
+
+    std::vector<int> physical(virtualCount, -1);
+    physical[0] = 0;   // theta is read in place and never written
+    std::vector<int> freeRegisters;
+    int used = 1;
+    for (int k = 0; k < end; k++) {
+        Instruction& instruction = varyingCode[k];
+        int a = instruction.a;
+        int b = instruction.b;
+        if (instruction.varying & 1) {
+            instruction.a = physical[a];
+            if (a != 0 && lastUse[a] == k) freeRegisters.push_back(physical[a]);
+        }
+        if (instruction.varying & 2) {
+            instruction.b = physical[b];
+            if (b != 0 && b != a && lastUse[b] == k) freeRegisters.push_back(physical[b]);
+        }
+        int dst = instruction.dst;
+        if (freeRegisters.empty()) {
+            physical[dst] = used++;
+        }
+        else {
+            physical[dst] = freeRegisters.back();
+            freeRegisters.pop_back();
+        }
+        instruction.dst = physical[dst];
+    }
+    if (outX.kind == Kind::Varying) outX.index = physical[outX.index];
+    if (outY.kind == Kind::Varying) outY.index = physical[outY.index];
+
+    registerCount = used;
+    if (registerCount > kMaxRegisters) {
+        error = "needs " + std::to_string(registerCount) + " registers, at most " +
+            std::to_string(kMaxRegisters) + " are available";
+        return false;
+    }
+    if (scalarCount > kMaxScalars) {
+        error = "too many constants and scalar terms";
+        return false;
+    }
+    return true;
+}
+
+bool CurveProgram::compile(const std::string& curveName, const std::vector<std::string>& lines, int firstLine,
+    std::string& error) {
+    *this = CurveProgram();
+    name = curveName;
+
+    std::map<std::string, Operand> locals;
+    bool hasX = false;
+    bool hasY = false;
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string line = stripComment(lines[i]);
+        if (line.empty()) continue;
+        const std::string where = "line " + std::to_string(firstLine + static_cast<int>(i)) + ": ";
+
+        size_t equals = line.find('=');
+        std::string target = trim(line.substr(0, equals));
+        if (equals == std::string::npos || target.empty()) {
+            error = where + "expected 'name = expression'";
+            return false;
+        }
+        for (char c : target) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                error = where + "bad name '" + target + "'";
+                return false;
+            }
+        }
+        bool reserved = target == "theta" || target == "pi" || std::isdigit(static_cast<unsigned char>(target[0]));
+        for (int k = 0; k < kInputCount; k++) {
+            if (target == kInputNames[k]) reserved = true;
+        }
+        if (reserved) {
+            error = where + "'" + target + "' can't be assigned";
+            return false;
+        }
+
+        std::string expressionText = line.substr(equals + 1);
+        Parser parser(*this, locals, expressionText);
+        Operand value;
+        if (!parser.expression(value) || !parser.atEnd()) {
+            error = where + (parser.error.empty() ? "unexpected '" + expressionText.substr(parser.pos) + "'" :
+                parser.error);
+            return false;
+        }
+        locals[target] = value;
+        if (target == "x") {
+            outX = value;
+            hasX = true;
+        }
+        else if (target == "y") {
+            outY = value;
+            hasY = true;
+        }
+    }
+
+    if (!hasX || !hasY) {
+        error = "line " + std::to_string(firstLine - 1) + ": curve '" + name + "' must assign x and y";
+        return false;
+    }
+    return allocateRegisters(error);
+}
+
+void CurveProgram::run(const CurveParams& p, const float* theta, float* x, float* y, int count) const {
+    float scalars[kMaxScalars];
+    std::copy(scalarInit.begin(), scalarInit.end(), scalars);
+    const float inputs[kInputCount] = {
+        p.r, p.t, p.tFactor, p.n3, p.param1, p.param2, p.bass, p.mid, p.treble, p.amplitude, p.beat
+    };
+    std::copy(inputs, inputs + kInputCount, scalars);
+    for (const Instruction& instruction : uniformCode) {
+        scalars[instruction.dst] = apply(instruction.op, scalars[instruction.a], scalars[instruction.b]);
+    }
+
+    float registers[kMaxRegisters][kBlock];
+    for (int start = 0; start < count; start += kBlock) {
+        const int n = (std::min)(kBlock, count - start);
+        const float* thetaBlock = theta + start;
+        auto varying = [&](int index) -> const float* {
+            return index == 0 ? thetaBlock : registers[index];
+        };
+
+        for (const Instruction& instruction : varyingCode) {
+            float* d = registers[instruction.dst];
+            const float* a = (instruction.varying & 1) ? varying(instruction.a) : nullptr;
+            const float* b = (instruction.varying & 2) ? varying(instruction.b) : nullptr;
+            const float sa = scalars[(instruction.varying & 1) ? 0 : instruction.a];
+            const float sb = scalars[(instruction.varying & 2) ? 0 : instruction.b];
+            const unsigned char mode = instruction.varying;
+
+            switch (instruction.op) {
+            case Op::Add: binaryLoop([](float u, float v) { return u + v; }, mode, d, a, sa, b, sb, n); break;
+            case Op::Sub: binaryLoop([](float u, float v) { return u - v; }, mode, d, a, sa, b, sb, n); break;
+            case Op::Mul: binaryLoop([](float u, float v) { return u * v; }, mode, d, a, sa, b, sb, n); break;
+            case Op::Div: binaryLoop([](float u, float v) { return u / v; }, mode, d, a, sa, b, sb, n); break;
+            case Op::Pow: binaryLoop([](float u, float v) { return std::pow(u, v); }, mode, d, a, sa, b, sb, n); break;
+            case Op::Atan2: binaryLoop([](float u, float v) { return std::atan2(u, v); }, mode, d, a, sa, b, sb, n); break;
+            case Op::Mod: binaryLoop([](float u, float v) { return std::fmod(u, v); }, mode, d, a, sa, b, sb, n); break;
+            case Op::Min: binaryLoop([](float u, float v) { return (std::min)(u, v); }, mode, d, a, sa, b, sb, n); break;
+            case Op::Max: binaryLoop([](float u, float v) { return (std::max)(u, v); }, mode, d, a, sa, b, sb, n); break;
+            case Op::Neg: unaryLoop([](float u) { return -u; }, d, a, n); break;
+            case Op::Sin: unaryLoop([](float u) { return std::sin(u); }, d, a, n); break;
+            case Op::Cos: unaryLoop([](float u) { return std::cos(u); }, d, a, n); break;
+            case Op::Tan: unaryLoop([](float u) { return std::tan(u); }, d, a, n); break;
+            case Op::Asin: unaryLoop([](float u) { return std::asin(u); }, d, a, n); break;
+            case Op::Acos: unaryLoop([](float u) { return std::acos(u); }, d, a, n); break;
+            case Op::Atan: unaryLoop([](float u) { return std::atan(u); }, d, a, n); break;
+            case Op::Sinh: unaryLoop([](float u) { return std::sinh(u); }, d, a, n); break;
+            case Op::Cosh: unaryLoop([](float u) { return std::cosh(u); }, d, a, n); break;
+            case Op::Tanh: unaryLoop([](float u) { return std::tanh(u); }, d, a, n); break;
+            case Op::Exp: unaryLoop([](float u) { return std::exp(u); }, d, a, n); break;
+            case Op::Log: unaryLoop([](float u) { return std::log(u); }, d, a, n); break;
+            case Op::Sqrt: unaryLoop([](float u) { return std::sqrt(u); }, d, a, n); break;
+            case Op::Abs: unaryLoop([](float u) { return std::fabs(u); }, d, a, n); break;
+            case Op::Floor: unaryLoop([](float u) { return std::floor(u); }, d, a, n); break;
+            case Op::Fract: unaryLoop([](float u) { return fract(u); }, d, a, n); break;
+            case Op::Noise: unaryLoop([](float u) { return noise(u); }, d, a, n); break;
+            }
+        }
+
+        if (outX.kind == Kind::Varying) std::copy(varying(outX.index), varying(outX.index) + n, x + start);
+        else std::fill(x + start, x + start + n, scalars[outX.index]);
+        if (outY.kind == Kind::Varying) std::copy(varying(outY.index), varying(outY.index) + n, y + start);
+        else std::fill(y + start, y + start + n, scalars[outY.index]);
+    }
+}
+
+namespace {
+    std::vector<CurveProgram>& loadedScripts() {
+        static std::vector<CurveProgram> scripts;
+        return scripts;
+    }
+
+    template <int N>
+    void scriptBatch(const CurveParams& p, const float* theta, float* x, float* y, int count) {
+        loadedScripts()[N].run(p, theta, x, y, count);
+    }
+
+    template <int... N>
+    std::array<CurveBatchKernel, sizeof...(N)> makeScriptTable(std::integer_sequence<int, N...>) {
+        return {{ &scriptBatch<N>... }};
+    }
+}
+
+int loadCurveScripts(const std::string& path) {
+    std::vector<CurveProgram>& scripts = loadedScripts();
+    scripts.clear();
+
+    std::ifstream file(path);
+    if (!file) {
+        writeDebugLog("Curve scripts: can't open " + path);
+        return 0;
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+
+    // Each definition runs from its `curve` line to the next one
+    for (size_t i = 0; i < lines.size();) {
+        std::string header = stripComment(lines[i]);
+        if (header.empty()) {
+            i++;
+            continue;
+        }
+        if (header.compare(0, 6, "curve ") != 0) {
+            writeDebugLog("Curve scripts " + path + ": line " + std::to_string(i + 1) + ": expected 'curve <name>'");
+            i++;
+            continue;
+        }
+        size_t bodyBegin = i + 1;
+        size_t bodyEnd = bodyBegin;
+        while (bodyEnd < lines.size() && stripComment(lines[bodyEnd]).compare(0, 6, "curve ") != 0) bodyEnd++;
+        i = bodyEnd;
+
+        std::string curveName = trim(header.substr(6));
+        if (static_cast<int>(scripts.size()) == kMaxCurveScripts) {
+            writeDebugLog("Curve scripts " + path + ": only " + std::to_string(kMaxCurveScripts) +
+                " curves are supported, skipping '" + curveName + "'");
+            continue;
+        }
+        CurveProgram program;
+        std::string error;
+        std::vector<std::string> body(lines.begin() + bodyBegin, lines.begin() + bodyEnd);
+        if (program.compile(curveName, body, static_cast<int>(bodyBegin) + 1, error)) {
+            scripts.push_back(program);
+        }
+        else {
+            writeDebugLog("Curve scripts " + path + ": '" + curveName + "' skipped, " + error);
+        }
+    }
+
+    writeDebugLog("Curve scripts: loaded " + std::to_string(scripts.size()) + " from " + path);
+    return static_cast<int>(scripts.size());
+}
+
+int getCurveScriptCount() {
+    return static_cast<int>(loadedScripts().size());
+}
+
+const CurveProgram* getCurveScript(int index) {
+    if (index < 0 || index >= getCurveScriptCount()) return nullptr;
+    return &loadedScripts()[index];
+}
+
+CurveBatchKernel curveScriptKernel(int index) {
+    static const std::array<CurveBatchKernel, kMaxCurveScripts> kScriptKernels =
+        makeScriptTable(std::make_integer_sequence<int, kMaxCurveScripts>());
+    if (index < 0 || index >= getCurveScriptCount()) return nullptr;
+    return kScriptKernels[index];
+}
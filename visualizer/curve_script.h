@@ -0,0 +1,100 @@
+#ifndef CURVE_SCRIPT_H
+#define CURVE_SCRIPT_H
+
+#include <string>
+#include <vector>
+#include "curve_kernels.h"
+
+// Curves authored in text files instead of C++. A file holds any number of
+// definitions:
+//
+//     # comment
+//     curve bloom
+//     wobble = 1 + 0.3 * sin(7 * theta + t * 3)
+//     x = r * cos(theta) * wobble
+//     y = r * sin(theta) * (wobble + bass)
+//
+// Lines after `curve <name>` assign expressions to names; the curve must
+// assign x and y, other names are locals for later lines. Expressions use
+// + - * / ^, parentheses, numbers, the point variable theta, the per-curve
+// inputs r t tfactor n3 param1 param2 bass mid treble amplitude beat pi
+// and the functions sin cos tan asin acos atan atan2 sinh cosh tanh exp log
+// sqrt abs floor fract mod min max pow noise.
+//
+// Each definition compiles to register bytecode in two parts. Anything not
+// depending on theta runs once per batch on scalars; the rest runs one
+// instruction at a time over blocks of points, so every instruction is a
+// tight loop over arrays instead of a per-point interpreter step.
+// Constant subexpressions are folded at compile time.
+class CurveProgram {
+private:
+    enum class Op : unsigned char {
+        Add, Sub, Mul, Div, Pow, Neg, Sin, Cos, Tan, Asin, Acos, Atan, Atan2, Sinh, Cosh, Tanh,
+        Exp, Log, Sqrt, Abs, Floor, Fract, Mod, Min, Max, Noise
+    };
+
+    enum class Kind : unsigned char { Constant, Uniform, Varying };
+
+    struct Operand {
+        Kind kind;
+        int index;     // scalar slot, or varying register
+        float value;   // for constants
+    };
+
+    struct Instruction {
+        Op op;
+        unsigned char varying;   // bit 0: a is varying, bit 1: b is varying
+        int dst;
+        int a;
+        int b;
+    };
+
+    std::string name;
+    std::vector<float> scalarInit;          // inputs (filled per run), then constants
+    int scalarCount;
+    std::vector<Instruction> uniformCode;   // scalar slots to scalar slots
+    std::vector<Instruction> varyingCode;   // onto varying registers; register 0 is theta
+    int registerCount;
+    Operand outX;
+    Operand outY;
+
+    // Compiler state
+    struct Parser;
+    int virtualCount;
+
+    Operand constant(float value);
+    Operand emit(Op op, Operand a, Operand b);
+    bool allocateRegisters(std::string& error);
+
+    static float apply(Op op, float a, float b);
+    static bool lookupFunction(const std::string& name, Op& op, int& arity);
+
+public:
+    CurveProgram();
+
+    // Compiles the lines after `curve <name>`. `firstLine` is the file line
+    // number of lines[0], for error messages.
+    bool compile(const std::string& curveName, const std::vector<std::string>& lines, int firstLine,
+        std::string& error);
+
+    void run(const CurveParams& p, const float* theta, float* x, float* y, int count) const;
+
+    const std::string& getName() const { return name; }
+    int getInstructionCount() const { return static_cast<int>(uniformCode.size() + varyingCode.size()); }
+    int getRegisterCount() const { return registerCount; }
+};
+
+// Scripted curves live after the built-in shapes, as types
+// kCurveTypeCount .. kCurveTypeCount + getCurveScriptCount() - 1.
+const int kMaxCurveScripts = 32;
+
+// Replaces the loaded scripts with the definitions in `path`. Definitions
+// with errors are skipped and logged. Returns the number loaded. Must not
+// run while curves are being evaluated.
+int loadCurveScripts(const std::string& path);
+int getCurveScriptCount();
+const CurveProgram* getCurveScript(int index);
+// Batch kernel for a loaded script, nullptr if there is none at `index`
+CurveBatchKernel curveScriptKernel(int index);
+
+#endif // CURVE_SCRIPT_H
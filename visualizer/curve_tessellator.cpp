@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include "curve_tessellator.h"
+
+CurveTessellator::CurveTessellator(float tolerance, int initialSegments, int maxDepth, int pointBudget) :
+tolerance(tolerance), initialSegments((std::max)(initialSegments, 1)), maxDepth(maxDepth),
+pointBudget(pointBudget), pointsLeft(pointBudget) {
+    stats = CurveTessellationStats();
+}
+
+void CurveTessellator::setTolerance(float pixels) {
+    if (pixels > 0.0f) tolerance = pixels;
+}
+
+void CurveTessellator::setPointBudget(int points) {
+    pointBudget = (std::max)(points, 0);
+}
+
+void CurveTessellator::beginFrame() {
+    pointsLeft = pointBudget;
+    stats = CurveTessellationStats();
+}
+
+void CurveTessellator::limitSplits(int keep) {
+    splitOrder.clear();
+    for (int k = 0; k < static_cast<int>(midError.size()); k++) {
+        if (midError[k] >= 0.0f) splitOrder.push_back(k);
+    }
+    std::nth_element(splitOrder.begin(), splitOrder.begin() + keep, splitOrder.end(),
+        [this](int a, int b) { return midError[a] > midError[b]; });
+    for (size_t k = keep; k < splitOrder.size(); k++) {
+        midError[splitOrder[k]] = -1.0f;
+    }
+}
+
+int CurveTessellator::tessellate(CurveBatchKernel kernel, const CurveParams& params, float thetaEnd,
+    std::vector<float>& theta, std::vector<float>& x, std::vector<float>& y) {
+    int segments = initialSegments;
+    theta.resize(segments + 1);
+    x.resize(segments + 1);
+    y.resize(segments + 1);
+    for (int i = 0; i <= segments; i++) {
+        theta[i] = thetaEnd * i / segments;
+    }
+    kernel(params, theta.data(), x.data(), y.data(), segments + 1);
+    stats.evaluations += segments + 1;
+    pointsLeft = (std::max)(pointsLeft - (segments + 1), 0);
+    active.assign(segments, 1);
+
+    const float tolerance2 = tolerance * tolerance;
+    bool limited = false;
+    for (int depth = 0; depth < maxDepth; depth++) {
+        midTheta.clear();
+        for (int i = 0; i < segments; i++) {
+            if (active[i]) midTheta.push_back(0.5f * (theta[i] + theta[i + 1]));
+        }
+        const int mids = static_cast<int>(midTheta.size());
+        if (mids == 0) break;
+
+        midX.resize(mids);
+        midY.resize(mids);
+        kernel(params, midTheta.data(), midX.data(), midY.data(), mids);
+        stats.evaluations += mids;
+
+        // Distance of the midpoint from the chord's midpoint; non-finite
+        // values (poles of the tan shapes) fail the comparison and are never
+        // chased further
+        midError.resize(mids);
+        int splits = 0;
+        for (int i = 0, k = 0; i < segments; i++) {
+            if (!active[i]) continue;
+            float ex = midX[k] - 0.5f * (x[i] + x[i + 1]);
+            float ey = midY[k] - 0.5f * (y[i] + y[i + 1]);
+            float error = ex * ex + ey * ey;
+            bool split = error > tolerance2 && std::isfinite(error);
+            midError[k++] = split ? error : -1.0f;
+            if (split) splits++;
+        }
+        if (splits > pointsLeft) {
+            limitSplits(pointsLeft);
+            splits = pointsLeft;
+            limited = true;
+        }
+        if (splits == 0) break;
+
+        nextTheta.clear();
+        nextX.clear();
+        nextY.clear();
+        nextActive.clear();
+        for (int i = 0, k = 0; i < segments; i++) {
+            nextTheta.push_back(theta[i]);
+            nextX.push_back(x[i]);
+            nextY.push_back(y[i]);
+            bool split = active[i] && midError[k++] >= 0.0f;
+            if (split) {
+                nextTheta.push_back(midTheta[k - 1]);
+                nextX.push_back(midX[k - 1]);
+                nextY.push_back(midY[k - 1]);
+                nextActive.push_back(1);
+                nextActive.push_back(1);
+            }
+            else {
+                nextActive.push_back(0);
+            }
+        }
+        nextTheta.push_back(theta[segments]);
+        nextX.push_back(x[segments]);
+        nextY.push_back(y[segments]);
+
+        theta.swap(nextTheta);
+        x.swap(nextX);
+        y.swap(nextY);
+        active.swap(nextActive);
+        segments += splits;
+        pointsLeft -= splits;
+        stats.passes = (std::max)(stats.passes, depth + 1);
+    }
+
+    stats.curves++;
+    stats.points += segments + 1;
+    if (limited) stats.budgetLimited++;
+    return segments + 1;
+}
@@ -0,0 +1,70 @@
+#ifndef CURVE_TESSELLATOR_H
+#define CURVE_TESSELLATOR_H
+
+#include <vector>
+#include "curve_kernels.h"
+
+// Counters since the last beginFrame()
+struct CurveTessellationStats {
+    int curves;          // curves tessellated
+    int points;          // points handed out
+    int evaluations;     // kernel evaluations, rejected midpoints included
+    int passes;          // deepest refinement of any curve
+    int budgetLimited;   // curves that ran into the point budget
+};
+
+// Adaptive sampling of the curve shapes. A curve starts as a coarse uniform
+// polyline; every pass evaluates the midpoint of each segment still being
+// refined (all of them in one batch kernel call) and splits the segments
+// whose midpoint is further than the tolerance from their chord. Flat
+// stretches stop after the first pass, spikes and tight loops keep
+// splitting until they are within tolerance or hit the depth limit.
+//
+// All curves of a frame share one point budget. When a pass wants more
+// splits than the budget has left, the segments with the largest error go
+// first. The coarse polyline itself is never cut, so a curve always has at
+// least the initial segments.
+class CurveTessellator {
+private:
+    float tolerance;       // pixels, kernels work in screen units
+    int initialSegments;
+    int maxDepth;
+    int pointBudget;       // per frame, all curves together
+    int pointsLeft;
+    CurveTessellationStats stats;
+
+    // Scratch, kept across curves and frames
+    std::vector<float> midTheta;
+    std::vector<float> midX;
+    std::vector<float> midY;
+    std::vector<float> midError;      // squared, negative if not split
+    std::vector<int> splitOrder;
+    std::vector<unsigned char> active;     // per segment: still refining
+    std::vector<unsigned char> nextActive;
+    std::vector<float> nextTheta;
+    std::vector<float> nextX;
+    std::vector<float> nextY;
+
+    // Drops the smallest splits until `keep` are left
+    void limitSplits(int keep);
+
+public:
+    CurveTessellator(float tolerance = 1.0f, int initialSegments = 64, int maxDepth = 6, int pointBudget = 4096);
+
+    void setTolerance(float pixels);
+    float getTolerance() const { return tolerance; }
+    void setPointBudget(int points);
+    int getPointBudget() const { return pointBudget; }
+
+    // Refills the point budget and resets the stats
+    void beginFrame();
+
+    // Samples `kernel` over [0, thetaEnd] into theta/x/y, ordered by theta.
+    // Returns the number of points.
+    int tessellate(CurveBatchKernel kernel, const CurveParams& params, float thetaEnd,
+        std::vector<float>& theta, std::vector<float>& x, std::vector<float>& y);
+
+    const CurveTessellationStats& getStats() const { return stats; }
+};
+
+#endif // CURVE_TESSELLATOR_H
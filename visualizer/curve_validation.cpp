@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "curve_kernels.h"
+#include "curve_script.h"
+#include "curve_validation.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Declare writeDebugLog as extern to use the implementation from engine.cpp
+extern void writeDebugLog(const std::string& message);
+
+namespace {
+    const int kPoints = 1024;
+    const float kFourTurns = 8.0f * static_cast<float>(M_PI);
+    // Seconds, from a fresh start to hours in
+    const float kTimes[] = { 0.0f, 1.7f, 13.0f, 60.0f, 240.0f, 900.0f, 3600.0f, 14400.0f };
+    const float kParams[] = { 0.5f, 1.0f, 2.0f, 3.0f, 4.5f, 6.0f };
+    const float kAudioLevels[] = { 0.0f, 0.5f, 1.0f };
+    // Radii; anything further out is off-screen at any size the curves are drawn
+    const float kFarRadii = 8.0f;
+
+    struct TypeStats {
+        double kernelNs;
+        long long points;
+        long long nonFinite;
+        long long far;
+        int worstTime;      // indices of the sweep step with the most non-finite points
+        int worstParam1;
+        int worstParam2;
+        long long worstNonFinite;
+    };
+}
+
+bool runCurveValidation(float slowTime) {
+    const int timeCount = sizeof(kTimes) / sizeof(kTimes[0]);
+    const int paramCount = sizeof(kParams) / sizeof(kParams[0]);
+    const int audioCount = sizeof(kAudioLevels) / sizeof(kAudioLevels[0]);
+    const int scripts = getCurveScriptCount();
+    const int types = kCurveTypeCount + scripts;
+
+    std::vector<float> theta(kPoints);
+    std::vector<float> x(kPoints);
+    std::vector<float> y(kPoints);
+    for (int i = 0; i < kPoints; i++) {
+        theta[i] = kFourTurns * i / (kPoints - 1);
+    }
+
+    std::vector<TypeStats> stats(types, TypeStats());
+    double sanitizeNs = 0.0;
+    long long sanitizedPoints = 0;
+    long long unsafe = 0;
+
+    for (int type = 0; type < types; type++) {
+        CurveBatchKernel kernel = curveKernel(type);
+        TypeStats& s = stats[type];
+        int step = 0;
+        for (int ti = 0; ti < timeCount; ti++) {
+            for (int p1 = 0; p1 < paramCount; p1++) {
+                for (int p2 = 0; p2 < paramCount; p2++, step++) {
+                    CurveParams params = makeCurveParams(type, 1.0f, kTimes[ti], slowTime,
+                        kParams[p1], kParams[p2]);
+                    // Scripts read the audio features; walk them through their range too
+                    params.bass = kAudioLevels[step % audioCount];
+                    params.mid = kAudioLevels[(step / audioCount) % audioCount];
+                    params.treble = kAudioLevels[(step + 1) % audioCount];
+                    params.amplitude = kAudioLevels[(step / audioCount + 1) % audioCount];
+                    params.beat = kAudioLevels[(step + 2) % audioCount];
+
+                    auto start = std::chrono::steady_clock::now();
+                    kernel(params, theta.data(), x.data(), y.data(), kPoints);
+                    s.kernelNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                    s.points += kPoints;
+
+                    long long nonFinite = 0;
+                    for (int i = 0; i < kPoints; i++) {
+                        if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+                            nonFinite++;
+                        }
+                        else if (std::fabs(x[i]) > kFarRadii || std::fabs(y[i]) > kFarRadii) {
+                            s.far++;
+                        }
+                    }
+                    s.nonFinite += nonFinite;
+                    if (nonFinite > s.worstNonFinite) {
+                        s.worstNonFinite = nonFinite;
+                        s.worstTime = ti;
+                        s.worstParam1 = p1;
+                        s.worstParam2 = p2;
+                    }
+
+                    start = std::chrono::steady_clock::now();
+                    sanitizedPoints += sanitizeCurvePoints(x.data(), y.data(), kPoints, kFarRadii);
+                    sanitizeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                    for (int i = 0; i < kPoints; i++) {
+                        if (!(std::fabs(x[i]) <= kFarRadii && std::fabs(y[i]) <= kFarRadii)) unsafe++;
+                    }
+                }
+            }
+        }
+    }
+
+    const long long pointsPerType = (long long)timeCount * paramCount * paramCount * kPoints;
+    writeDebugLog("=== CURVE VALIDATION (" + std::to_string(kCurveTypeCount) + " built-in, " +
+        std::to_string(scripts) + " scripted, " + std::to_string(pointsPerType) + " points each) ===");
+    writeDebugLog("type  ns/point  non-finite %  beyond " + std::to_string((int)kFarRadii) + "r %  name");
+
+    std::vector<int> order;
+    double totalNs = 0.0;
+    long long totalPoints = 0;
+    for (int type = 0; type < types; type++) {
+        const TypeStats& s = stats[type];
+        totalNs += s.kernelNs;
+        totalPoints += s.points;
+        if (s.nonFinite > 0) order.push_back(type);
+
+        std::stringstream ss;
+        ss << std::setw(4) << type << std::fixed << std::setprecision(1) << std::setw(10) << s.kernelNs / s.points
+            << std::setprecision(3) << std::setw(14) << 100.0 * s.nonFinite / s.points
+            << std::setw(11) << 100.0 * s.far / s.points << "  "
+            << (type < kCurveTypeCount ? "built-in" : getCurveScript(type - kCurveTypeCount)->getName());
+        if (s.nonFinite > 0) {
+            ss << " (worst " << s.worstNonFinite << "/" << kPoints << " at t " << kTimes[s.worstTime] << ", param1 "
+                << kParams[s.worstParam1] << ", param2 " << kParams[s.worstParam2] << ")";
+        }
+        writeDebugLog(ss.str());
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "average " << totalNs / totalPoints << " ns/point, sanitizing "
+        << sanitizeNs / totalPoints << " ns/point";
+    writeDebugLog(ss.str());
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return stats[a].nonFinite > stats[b].nonFinite; });
+    ss.str("");
+    ss << order.size() << " types produce non-finite points";
+    for (size_t i = 0; i < order.size(); i++) {
+        ss << (i == 0 ? ": " : ", ") << order[i];
+    }
+    writeDebugLog(ss.str());
+
+    int slowest = 0;
+    for (int type = 1; type < types; type++) {
+        if (stats[type].kernelNs / stats[type].points > stats[slowest].kernelNs / stats[slowest].points) slowest = type;
+    }
+    ss.str("");
+    ss << std::fixed << std::setprecision(1) << "slowest: type " << slowest << " at "
+        << stats[slowest].kernelNs / stats[slowest].points << " ns/point";
+    writeDebugLog(ss.str());
+
+    writeDebugLog(std::to_string(sanitizedPoints) + " points clamped or replaced, " + std::to_string(unsafe) +
+        " still unsafe after sanitizing" + (unsafe > 0 ? " (FAILED)" : ""));
+    return unsafe == 0;
+}
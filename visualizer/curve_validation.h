@@ -0,0 +1,12 @@
+#ifndef CURVE_VALIDATION_H
+#define CURVE_VALIDATION_H
+
+// Sweeps every curve type, built-in and loaded scripts, over time, both
+// params and the audio inputs, and writes to the debug log what each one
+// costs per point and how often its points come out non-finite or far out
+// of range. Returns false if any point is still unsafe to draw after
+// sanitizeCurvePoints.
+// `slowTime` as passed to makeCurveParams.
+bool runCurveValidation(float slowTime);
+
+#endif // CURVE_VALIDATION_H
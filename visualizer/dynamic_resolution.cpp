@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cmath>
+#include "dynamic_resolution.h"
+
+namespace {
+    const float kStep = 1.0f / 16.0f;          // scale quantization
+    const float kAverageSeconds = 0.25f;       // frame time smoothing
+    const float kBudgetFraction = 0.9f;        // aim below the frame budget
+    const float kRaiseBelow = 0.7f;            // headroom needed to raise the scale
+    const float kMaxDropFactor = 0.75f;        // largest single reduction
+    const float kSettleAfterDrop = 0.5f;       // seconds
+    const float kSettleAfterRaise = 1.0f;
+
+    float quantize(float scale) {
+        return std::floor(scale / kStep + 0.5f) * kStep;
+    }
+}
+
+DynamicResolution::DynamicResolution(float targetFps, float minScale, float maxScale) :
+minScale(minScale), maxScale(maxScale), scale(maxScale), targetFrameMs(1000.0f / targetFps),
+averageMs(0.0f), settleTime(0.0f), enabled(true), changeCount(0) {
+}
+
+void DynamicResolution::setTargetFps(float fps) {
+    if (fps > 0.0f) targetFrameMs = 1000.0f / fps;
+}
+
+void DynamicResolution::setEnabled(bool enable) {
+    enabled = enable;
+    if (!enabled && scale != maxScale) {
+        scale = maxScale;
+        changeCount++;
+    }
+    settleTime = kSettleAfterDrop;
+}
+
+bool DynamicResolution::update(float frameMs, float deltaTime) {
+    float alpha = std::min(1.0f, deltaTime / kAverageSeconds);
+    averageMs = averageMs > 0.0f ? averageMs + alpha * (frameMs - averageMs) : frameMs;
+
+    if (!enabled) return false;
+    if (settleTime > 0.0f) {
+        settleTime -= deltaTime;
+        return false;
+    }
+
+    const float budget = targetFrameMs * kBudgetFraction;
+    float wanted = scale;
+    if (averageMs > budget) {
+        wanted = scale * std::max(kMaxDropFactor, std::sqrt(budget / averageMs));
+        wanted = std::min(wanted, scale - kStep);
+    }
+    else if (averageMs < budget * kRaiseBelow) {
+        wanted = scale + kStep;
+    }
+
+    wanted = std::max(minScale, std::min(maxScale, quantize(wanted)));
+    if (wanted == scale) return false;
+
+    settleTime = wanted < scale ? kSettleAfterDrop : kSettleAfterRaise;
+    scale = wanted;
+    changeCount++;
+    return true;
+}
+
+int DynamicResolution::scaled(int fullSize) const {
+    return std::max(1, (int)(fullSize * scale + 0.5f));
+}
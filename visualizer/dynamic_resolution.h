@@ -0,0 +1,46 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+// Frame-time controller for the internal resolution of full-screen
+// procedural layers (the plasma). Layers render at scale * screen size and
+// are stretched back up by SDL_RenderCopy.
+//
+// The measured frame work time is smoothed. When it runs over the budget,
+// the scale drops by the square root of the overrun, since cost follows
+// pixel area. When there is clear headroom it climbs back in small steps.
+// Scales are quantized to 1/16 and changes are spaced out, so textures and
+// caches aren't rebuilt every frame and the controller doesn't oscillate.
+class DynamicResolution {
+private:
+    float minScale;
+    float maxScale;
+    float scale;
+    float targetFrameMs;
+    float averageMs;       // smoothed work time per frame
+    float settleTime;      // seconds until the next change is allowed
+    bool enabled;
+    unsigned int changeCount;
+
+public:
+    DynamicResolution(float targetFps = 60.0f, float minScale = 0.25f, float maxScale = 1.0f);
+
+    void setTargetFps(float fps);
+    float getTargetFrameMs() const { return targetFrameMs; }
+
+    // Disabled pins the scale to the maximum
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled; }
+
+    // Feed the work time of the frame just finished (excluding any sleep).
+    // Returns true if the scale changed.
+    bool update(float frameMs, float deltaTime);
+
+    float getScale() const { return scale; }
+    float getAverageFrameMs() const { return averageMs; }
+    unsigned int getChangeCount() const { return changeCount; }
+
+    // A full-resolution dimension at the current scale, at least 1
+    int scaled(int fullSize) const;
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -3,6 +3,7 @@
  
 #include <Windows.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -18,6 +19,9 @@
 // Global debug file
 std::ofstream debugFile;
 
+// Nominal analysis hop, update() runs the analysis at most this often
+const float kHopSeconds = 0.016f;
+
 void writeDebugLog(const std::string& message) {
     if (!debugFile.is_open()) {
         debugFile.open("audio_debug.txt", std::ios::app);
@@ -50,6 +54,25 @@ bufferSize(2048), currentWritePos(0) {
         hanningWindow[i] = 0.5f * (1.0f - cos(2.0f * M_PI * i / (bufferSize - 1)));
     }
 
+    // Log-spaced band centers, eight bands per octave from 20 Hz
+    const int numBands = static_cast<int>(smoothedFreqData.size());
+    bandFrequencies.resize(numBands);
+    for (int band = 0; band < numBands; band++) {
+        bandFrequencies[band] = 20.0f * pow(2.0f, (float)band / 8.0f);
+    }
+    drumOnsets.configure(bandFrequencies.data(), numBands);
+    spectrogram.configure(numBands, 8.0f, kHopSeconds);
+    // 13 MFCCs every 0.5 s, 8 s checkerboard, sections at least 16 s apart
+    sectionNovelty.configure(numBands, 13, 0.5f, 8, 16.0f);
+
+    // Per-band envelope followers: fast attack everywhere, bass releases
+    // quicker than the treble so kicks stay punchy and hats don't flicker
+    bandEnvelopes.resize(numBands);
+    for (int i = 0; i < numBands; i++) {
+        float position = (float)i / numBands;
+        bandEnvelopes.setTimes(i, 0.010f + 0.025f * position, 0.120f + 0.130f * position);
+    }
+
     simulationMode = false;
     lastUpdateTime = 0;
     audioLevel = 0.0f;
@@ -93,22 +116,30 @@ bool AudioEngine::initialize() {
     std::ofstream clearFile("audio_debug.txt", std::ios::trunc);
     clearFile.close();
 
+    AudioSource::Callback feed = [this](const float* data, size_t frames) {
+        if (!data || frames == 0) return;
+        // Convert to byte stream for existing processing
+        const Uint8* byteStream = reinterpret_cast<const Uint8*>(data);
+        size_t byteLen = frames * sizeof(float) * 2; // stereo float
+        this->processAudioInput(const_cast<Uint8*>(byteStream), byteLen);
+    };
+
     // Initialize WASAPI loopback capture
-    wasapiCapture = std::make_unique<WASAPICapture>();
-    bool success = wasapiCapture->initialize(
-        [this](const float* data, size_t frames) {
-            if (!data || frames == 0) return;
-            // Convert to byte stream for existing processing
-            const Uint8* byteStream = reinterpret_cast<const Uint8*>(data);
-            size_t byteLen = frames * sizeof(float) * 2; // stereo float
-            this->processAudioInput(const_cast<Uint8*>(byteStream), byteLen);
-        }
-    );
+    audioSource = std::make_unique<WASAPICapture>();
+    bool success = audioSource->initialize(feed);
 
     if (!success) {
         writeDebugLog("WASAPI loopback initialization FAILED!");
         writeDebugLog("Falling back to simulation mode.");
         simulationMode = true;
+
+        // Same data path as live capture, fed by the synthetic generator
+        std::unique_ptr<SignalGenerator> generator = std::make_unique<SignalGenerator>(sampleRate);
+        generator->loadPreset(SignalPreset::Demo);
+        audioSource.reset();
+        audioSource = std::move(generator);
+        audioSource->initialize(feed);
+
         initialized = true;
         return true;
     }
@@ -121,11 +152,6 @@ bool AudioEngine::initialize() {
 }
 
 void AudioEngine::processAudioInput(Uint8* stream, size_t len) {
-    if (simulationMode) {
-        writeDebugLog("ERROR: processAudioInput called in simulation mode!");
-        return;
-    }
-
     callbackCount++;
 
     // Log first few callbacks for debugging
@@ -182,14 +208,12 @@ void AudioEngine::update() {
 
     Uint32 currentTime = SDL_GetTicks();
     if (currentTime - lastUpdateTime < 16) return; // Limit to ~60fps
+    // Clamp the hop so a stall (window drag, breakpoint) doesn't snap the envelopes
+    float hopSeconds = std::min(0.1f, (currentTime - lastUpdateTime) / 1000.0f);
     lastUpdateTime = currentTime;
 
-    if (simulationMode) {
-        generateRealisticSimulation();
-    }
-
     std::lock_guard<std::mutex> lock(bufferMutex);
-    performOptimizedFFT();
+    performOptimizedFFT(hopSeconds);
 
     // Debug output every 2 seconds
     static int debugCounter = 0;
@@ -223,44 +247,13 @@ void AudioEngine::update() {
     }
 }
 
-void AudioEngine::generateRealisticSimulation() {
-    static float time = 0.0f;
-    static bool loggedSim = false;
-
-    if (!loggedSim) {
-        writeDebugLog("Running in simulation mode - generating test audio");
-        loggedSim = true;
-    }
-
-    time += 0.016f;
-
-    std::lock_guard<std::mutex> lock(bufferMutex);
-
-    // Create test signal
-    for (size_t i = 0; i < audioBuffer.size(); i++) {
-        float sample = 0.0f;
-        float t = time + i * 0.0001f;
-
-        // Bass
-        sample += 0.6f * sin(2.0f * M_PI * 60.0f * t);
-        // Mid
-        sample += 0.4f * sin(2.0f * M_PI * 440.0f * t);
-        // High
-        sample += 0.2f * sin(2.0f * M_PI * 2000.0f * t);
-
-        audioBuffer[i] = sample * 0.5f;
-    }
-
-    audioLevel = 0.5f;
-}
-
-void AudioEngine::performOptimizedFFT() {
+void AudioEngine::performOptimizedFFT(float deltaTime) {
     const int numBands = 64;
     std::vector<float> magnitudes(numBands, 0.0f);
 
     // Simple frequency analysis
     for (int band = 0; band < numBands; band++) {
-        float frequency = 20.0f * pow(2.0f, (float)band / 8.0f);
+        float frequency = bandFrequencies[band];
         float real = 0.0f, imag = 0.0f;
 
         int step = std::max(1, bufferSize / 512);
@@ -276,12 +269,19 @@ void AudioEngine::performOptimizedFFT() {
         magnitudes[band] = sqrt(real * real + imag * imag) / (bufferSize / step);
     }
 
-    // Apply scaling and smoothing
+    // Apply scaling, then one attack/release pass over all bands
+    for (int i = 0; i < numBands; i++) {
+        magnitudes[i] = log(1.0f + magnitudes[i] * 10000.0f) * 0.1f;
+    }
+    spectrogram.push(magnitudes.data());
+    drumOnsets.process(magnitudes.data(), numBands, deltaTime);
+    sectionNovelty.process(magnitudes.data(), deltaTime);
+    bandEnvelopes.process(magnitudes.data(), deltaTime);
+
+    const float* envelope = bandEnvelopes.values();
     for (int i = 0; i < numBands; i++) {
-        float logMag = log(1.0f + magnitudes[i] * 10000.0f) * 0.1f;
-        float smoothFactor = 0.2f + 0.6f * (float)i / numBands;
-        smoothedFreqData[i] = smoothedFreqData[i] * smoothFactor + logMag * (1.0f - smoothFactor);
-        frequencyData[i] = smoothedFreqData[i];
+        smoothedFreqData[i] = envelope[i];
+        frequencyData[i] = envelope[i];
     }
 
     // Normalize
@@ -293,6 +293,113 @@ void AudioEngine::performOptimizedFFT() {
     }
 }
 
+void AudioEngine::resetAnalysis() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    std::fill(audioBuffer.begin(), audioBuffer.end(), 0.0f);
+    std::fill(frequencyData.begin(), frequencyData.end(), 0.0f);
+    std::fill(smoothedFreqData.begin(), smoothedFreqData.end(), 0.0f);
+    currentWritePos = 0;
+    audioLevel = 0.0f;
+    bandEnvelopes.reset();
+    drumOnsets.configure(bandFrequencies.data(), static_cast<int>(bandFrequencies.size()));
+    spectrogram.clear();
+    sectionNovelty.reset();
+}
+
+void AudioEngine::analyzeOffline(const float* stereo, size_t frames) {
+    if (frames == 0) return;
+    processAudioInput(reinterpret_cast<Uint8*>(const_cast<float*>(stereo)), frames * sizeof(float) * 2);
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    performOptimizedFFT(static_cast<float>(frames) / sampleRate);
+}
+
+void AudioEngine::runAnalysisBenchmark() {
+    struct BenchCase {
+        const char* name;
+        SignalPreset preset;
+        float expectedBpm;    // 0 when there is no beat to find
+    };
+    const BenchCase cases[] = {
+        { "silence", SignalPreset::Silence, 0.0f },
+        { "sine sweep 20Hz-20kHz", SignalPreset::SineSweep, 0.0f },
+        { "pink noise", SignalPreset::PinkNoise, 0.0f },
+        { "kicks 120 BPM", SignalPreset::Kicks120, 120.0f },
+        { "demo mix", SignalPreset::Demo, 120.0f },
+    };
+    const float seconds = 30.0f;
+    const size_t hopFrames = static_cast<size_t>(sampleRate * kHopSeconds);
+    const int hops = static_cast<int>(seconds / kHopSeconds);
+    std::vector<float> stereo(hopFrames * 2);
+
+    writeDebugLog("=== ANALYSIS BENCHMARK (" + std::to_string((int)seconds) + " s per signal) ===");
+    for (const BenchCase& bench : cases) {
+        SignalGenerator generator(sampleRate, 1234);
+        generator.loadPreset(bench.preset);
+        resetAnalysis();
+
+        // Onset and section counters run for the engine's lifetime, report deltas
+        unsigned int baseCounts[3];
+        for (int d = 0; d < 3; d++) baseCounts[d] = drumOnsets.count(static_cast<DrumClass>(d));
+        unsigned int baseSections = sectionNovelty.getBoundaryCount();
+
+        unsigned int firstKickCount = 0;
+        float firstKickTime = -1.0f, lastKickTime = 0.0f;
+        unsigned int lastCount = baseCounts[0];
+        double peakBandError = 0.0;
+        int peakBandSamples = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int hop = 0; hop < hops; hop++) {
+            generator.render(stereo.data(), hopFrames);
+            analyzeOffline(stereo.data(), hopFrames);
+
+            unsigned int kicks = drumOnsets.count(DrumClass::Kick);
+            if (kicks != lastCount) {
+                float now = (hop + 1) * kHopSeconds;
+                if (firstKickTime < 0.0f) {
+                    firstKickTime = now;
+                    firstKickCount = kicks;
+                }
+                lastKickTime = now;
+                lastCount = kicks;
+            }
+
+            // Sweep: the loudest band should track the instantaneous frequency
+            if (bench.preset == SignalPreset::SineSweep) {
+                double t = std::fmod(generator.getTime(), 10.0);
+                double f = 20.0 * std::pow(1000.0, t / 10.0);
+                if (f < bandFrequencies.back()) {
+                    const float* bands = spectrogram.newest();
+                    int peak = static_cast<int>(std::max_element(bands, bands + spectrogram.bins()) - bands);
+                    peakBandError += std::fabs(peak - 8.0 * std::log2(f / 20.0));
+                    peakBandSamples++;
+                }
+            }
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << bench.name << ": "
+            << elapsedMs << " ms (" << (seconds * 1000.0 / std::max(elapsedMs, 0.001)) << "x real time)"
+            << " | onsets kick/snare/hat " << (drumOnsets.count(DrumClass::Kick) - baseCounts[0]) << "/"
+            << (drumOnsets.count(DrumClass::Snare) - baseCounts[1]) << "/"
+            << (drumOnsets.count(DrumClass::HiHat) - baseCounts[2])
+            << " | sections " << (sectionNovelty.getBoundaryCount() - baseSections);
+        if (lastCount > firstKickCount) {
+            float bpm = 60.0f * (lastCount - firstKickCount) / (lastKickTime - firstKickTime);
+            ss << " | kick tempo " << bpm << " BPM";
+            if (bench.expectedBpm > 0.0f) ss << " (expected " << bench.expectedBpm << ")";
+        }
+        if (peakBandSamples > 0) {
+            ss << " | mean peak band error " << (peakBandError / peakBandSamples) << " bands";
+        }
+        writeDebugLog(ss.str());
+    }
+    resetAnalysis();
+    writeDebugLog("=== ANALYSIS BENCHMARK COMPLETE ===");
+}
+
 std::vector<float> AudioEngine::getFrequencyData() const {
     std::lock_guard<std::mutex> lock(bufferMutex);
     return frequencyData;
@@ -312,6 +419,30 @@ float AudioEngine::getAmplitude() const {
     return std::min(1.0f, audioLevel * 2.0f);
 }
 
+float AudioEngine::getDrumPulse(DrumClass drum) const {
+    return drumOnsets.pulse(drum);
+}
+
+unsigned int AudioEngine::getDrumOnsetCount(DrumClass drum) const {
+    return drumOnsets.count(drum);
+}
+
+SpectrogramView AudioEngine::getSpectrogram(float seconds) const {
+    return spectrogram.lastSeconds(seconds);
+}
+
+void AudioEngine::setSpectrogramHistory(float seconds) {
+    spectrogram.configure(spectrogram.bins(), seconds, kHopSeconds);
+}
+
+float AudioEngine::getNovelty() const {
+    return sectionNovelty.getNovelty();
+}
+
+unsigned int AudioEngine::getSectionChangeCount() const {
+    return sectionNovelty.getBoundaryCount();
+}
+
 bool AudioEngine::isSimulationMode() const {
     return simulationMode;
 }
@@ -324,10 +455,10 @@ void AudioEngine::cleanup() {
     if (initialized) {
         writeDebugLog("Cleaning up audio engine...");
 
-        if (wasapiCapture) {
-            wasapiCapture->shutdown();
-            wasapiCapture.reset();
-            writeDebugLog("WASAPI capture shutdown complete.");
+        if (audioSource) {
+            audioSource->shutdown();
+            audioSource.reset();
+            writeDebugLog(simulationMode ? "Signal generator shutdown complete." : "WASAPI capture shutdown complete.");
         }
 
         initialized = false;
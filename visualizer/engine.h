@@ -7,6 +7,11 @@
 #include <memory> // Added for std::unique_ptr
 #include <cmath>
 #include "wasapi_capture.h"
+#include "signal_generator.h"
+#include "envelope_follower.h"
+#include "onset_detector.h"
+#include "spectrogram_ring.h"
+#include "novelty_detector.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -25,7 +30,12 @@ private:
     std::vector<float> frequencyData;
     std::vector<float> smoothedFreqData;
     std::vector<float> hanningWindow;
-    std::unique_ptr<WASAPICapture> wasapiCapture;
+    std::vector<float> bandFrequencies;
+    EnvelopeFollowerBank bandEnvelopes;
+    DrumOnsetDetector drumOnsets;
+    SpectrogramRing spectrogram; // raw log band magnitudes, one frame per hop
+    NoveltyDetector sectionNovelty;
+    std::unique_ptr<AudioSource> audioSource; // WASAPI loopback, or the generator in simulation mode
 
     int currentWritePos;
     mutable std::mutex bufferMutex;
@@ -40,8 +50,8 @@ private:
 
     // Internal processing methods
     void processAudioInput(Uint8* stream, size_t len);
-    void generateRealisticSimulation();
-    void performOptimizedFFT();
+    void performOptimizedFFT(float deltaTime);
+    void resetAnalysis();
 
 public:
     AudioEngine();
@@ -51,12 +61,35 @@ public:
     void update();
     void cleanup();
 
+    // Push interleaved stereo frames and run one analysis hop over them
+    // immediately, without the real-time rate limit of update(). Use on an
+    // engine that was not initialize()d (benchmarks, regression runs).
+    void analyzeOffline(const float* stereo, size_t frames);
+    // Runs the generator presets through the analysis faster than real time
+    // and writes timing, band, onset and tempo results to the debug log
+    void runAnalysisBenchmark();
+
     // Data access methods
     std::vector<float> getFrequencyData() const;
     float getBeat() const;
     float getAmplitude() const;
     bool isSimulationMode() const;
     float getAudioLevel() const;
+
+    // Per drum class: decaying 0..1 hit pulse, and a running onset counter
+    // so callers can tell new hits apart from the previous frame's
+    float getDrumPulse(DrumClass drum) const;
+    unsigned int getDrumOnsetCount(DrumClass drum) const;
+
+    // Zero-copy view of the last `seconds` of band spectra, oldest first.
+    // Only valid on the thread calling update(), until the next update().
+    SpectrogramView getSpectrogram(float seconds) const;
+    const SpectrogramRing& getSpectrogramRing() const { return spectrogram; }
+    void setSpectrogramHistory(float seconds);
+
+    // Structural novelty and a running count of detected section changes
+    float getNovelty() const;
+    unsigned int getSectionChangeCount() const;
 };
 
 #endif // ENGINE_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+#include "envelope_follower.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ENVELOPE_USE_SSE2 1
+#endif
+
+EnvelopeFollowerBank::EnvelopeFollowerBank() : bandCount(0), coeffDeltaTime(-1.0f) {
+}
+
+void EnvelopeFollowerBank::resize(int bands) {
+    bandCount = bands;
+    attackTime.resize(bands, 0.01f);
+    releaseTime.resize(bands, 0.1f);
+    attackCoeff.resize(bands, 0.0f);
+    releaseCoeff.resize(bands, 0.0f);
+    envelope.resize(bands, 0.0f);
+    coeffDeltaTime = -1.0f;
+}
+
+void EnvelopeFollowerBank::setTimes(int band, float attackSeconds, float releaseSeconds) {
+    if (band < 0 || band >= bandCount) return;
+    attackTime[band] = std::max(attackSeconds, 0.0001f);
+    releaseTime[band] = std::max(releaseSeconds, 0.0001f);
+    coeffDeltaTime = -1.0f;
+}
+
+void EnvelopeFollowerBank::reset(float value) {
+    std::fill(envelope.begin(), envelope.end(), value);
+}
+
+void EnvelopeFollowerBank::updateCoefficients(float deltaTime) {
+    // Exact one-pole step for a hop of deltaTime seconds
+    for (int i = 0; i < bandCount; i++) {
+        attackCoeff[i] = 1.0f - expf(-deltaTime / attackTime[i]);
+        releaseCoeff[i] = 1.0f - expf(-deltaTime / releaseTime[i]);
+    }
+    coeffDeltaTime = deltaTime;
+}
+
+void EnvelopeFollowerBank::process(const float* input, float deltaTime) {
+    if (bandCount == 0 || deltaTime <= 0.0f) return;
+
+    // Hop lengths jitter by a millisecond around the update rate, only
+    // recompute the coefficients when the hop actually changed
+    if (fabsf(deltaTime - coeffDeltaTime) > 0.0005f) {
+        updateCoefficients(deltaTime);
+    }
+
+    float* env = envelope.data();
+    const float* ca = attackCoeff.data();
+    const float* cr = releaseCoeff.data();
+    int i = 0;
+
+#ifdef ENVELOPE_USE_SSE2
+    for (; i + 4 <= bandCount; i += 4) {
+        __m128 x = _mm_loadu_ps(input + i);
+        __m128 y = _mm_loadu_ps(env + i);
+        __m128 rising = _mm_cmpgt_ps(x, y);
+        __m128 c = _mm_or_ps(_mm_and_ps(rising, _mm_loadu_ps(ca + i)),
+            _mm_andnot_ps(rising, _mm_loadu_ps(cr + i)));
+        y = _mm_add_ps(y, _mm_mul_ps(c, _mm_sub_ps(x, y)));
+        _mm_storeu_ps(env + i, y);
+    }
+#endif
+
+    for (; i < bandCount; i++) {
+        float c = input[i] > env[i] ? ca[i] : cr[i];
+        env[i] += c * (input[i] - env[i]);
+    }
+}
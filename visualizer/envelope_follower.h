@@ -0,0 +1,37 @@
+#ifndef ENVELOPE_FOLLOWER_H
+#define ENVELOPE_FOLLOWER_H
+
+#include <vector>
+
+// Bank of attack/release envelope followers, one per frequency band.
+// Time constants are given in seconds and converted to per-hop coefficients
+// from the measured hop length, so the response is the same whether
+// process() runs at 30, 60 or 240 Hz.
+class EnvelopeFollowerBank {
+private:
+    int bandCount;
+    float coeffDeltaTime; // hop length the coefficients were computed for
+
+    std::vector<float> attackTime;
+    std::vector<float> releaseTime;
+    std::vector<float> attackCoeff;
+    std::vector<float> releaseCoeff;
+    std::vector<float> envelope;
+
+    void updateCoefficients(float deltaTime);
+
+public:
+    EnvelopeFollowerBank();
+
+    void resize(int bands);
+    void setTimes(int band, float attackSeconds, float releaseSeconds);
+    void reset(float value = 0.0f);
+
+    // Advance every band by deltaTime seconds towards input[band]
+    void process(const float* input, float deltaTime);
+
+    const float* values() const { return envelope.data(); }
+    int size() const { return bandCount; }
+};
+
+#endif // ENVELOPE_FOLLOWER_H
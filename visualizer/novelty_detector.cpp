@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cmath>
+#include "novelty_detector.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    const float kStatsSeconds = 30.0f;   // adaptive threshold memory
+    const float kThresholdScale = 1.5f;
+    const float kMinNovelty = 0.05f;
+    const int kResyncPeriod = 4;         // full block-sum recompute every 4 windows
+}
+
+NoveltyDetector::NoveltyDetector() : bandCount(0), coeffCount(0), halfWidth(0),
+featureSeconds(0.5f), minSectionSeconds(16.0f), accumHops(0), accumTime(0.0f),
+windowFrames(0), head(0), filled(0), pastSum(0.0), futureSum(0.0), crossSum(0.0),
+framesSinceResync(0), novelty(0.0f), noveltyMean(0.0f), noveltyDeviation(0.0f),
+previousNovelty(0.0f), risingNovelty(false), timeSinceBoundary(0.0f),
+boundary(false), boundaryCount(0) {
+}
+
+void NoveltyDetector::configure(int bands, int coefficients, float featureHopSeconds,
+    int kernelHalfWidth, float minSectionLength) {
+    bandCount = bands;
+    coeffCount = coefficients;
+    featureSeconds = featureHopSeconds;
+    halfWidth = std::max(1, kernelHalfWidth);
+    minSectionSeconds = minSectionLength;
+    windowFrames = 2 * halfWidth;
+
+    // DCT-II basis, skipping c0 so overall loudness doesn't count as timbre
+    dctMatrix.resize(coeffCount * bandCount);
+    for (int k = 0; k < coeffCount; k++) {
+        for (int b = 0; b < bandCount; b++) {
+            dctMatrix[k * bandCount + b] = cosf((float)M_PI * (k + 1) * (b + 0.5f) / bandCount);
+        }
+    }
+
+    bandAccum.assign(bandCount, 0.0f);
+    features.assign(windowFrames * coeffCount, 0.0f);
+    similarity.assign(windowFrames * windowFrames, 0.0f);
+    reset();
+}
+
+void NoveltyDetector::reset() {
+    std::fill(bandAccum.begin(), bandAccum.end(), 0.0f);
+    accumHops = 0;
+    accumTime = 0.0f;
+    head = 0;
+    filled = 0;
+    pastSum = futureSum = crossSum = 0.0;
+    framesSinceResync = 0;
+    novelty = noveltyMean = noveltyDeviation = previousNovelty = 0.0f;
+    risingNovelty = false;
+    timeSinceBoundary = 0.0f;
+    boundary = false;
+}
+
+double NoveltyDetector::rowSum(int row, int colBegin, int colEnd) const {
+    double sum = 0.0;
+    for (int col = colBegin; col < colEnd; col++) sum += sim(row, col);
+    return sum;
+}
+
+double NoveltyDetector::blockSum(int rowBegin, int rowEnd, int colBegin, int colEnd) const {
+    double sum = 0.0;
+    for (int row = rowBegin; row < rowEnd; row++) sum += rowSum(row, colBegin, colEnd);
+    return sum;
+}
+
+void NoveltyDetector::resync() {
+    pastSum = blockSum(0, halfWidth, 0, halfWidth);
+    futureSum = blockSum(halfWidth, windowFrames, halfWidth, windowFrames);
+    crossSum = blockSum(0, halfWidth, halfWidth, windowFrames);
+    framesSinceResync = 0;
+}
+
+void NoveltyDetector::pushFeature(const float* feature) {
+    const int L = halfWidth;
+    const int W = windowFrames;
+
+    // Similarity of the incoming frame against every stored one, indexed
+    // in the current (pre-slide) window order
+    float incoming[256];
+    float* newSims = W <= 256 ? incoming : nullptr;
+    std::vector<float> heapSims;
+    if (!newSims) {
+        heapSims.resize(W);
+        newSims = heapSims.data();
+    }
+    for (int i = 0; i < filled; i++) {
+        const float* other = &features[slot(i) * coeffCount];
+        float dot = 0.0f;
+        for (int k = 0; k < coeffCount; k++) dot += feature[k] * other[k];
+        newSims[i] = dot;
+    }
+    float selfSim = 0.0f;
+    for (int k = 0; k < coeffCount; k++) selfSim += feature[k] * feature[k];
+
+    if (filled < W) {
+        // Still filling the first window, nothing slides yet
+        int s = slot(filled);
+        std::copy(feature, feature + coeffCount, &features[s * coeffCount]);
+        for (int i = 0; i < filled; i++) {
+            similarity[s * W + slot(i)] = newSims[i];
+            similarity[slot(i) * W + s] = newSims[i];
+        }
+        similarity[s * W + s] = selfSim;
+        filled++;
+        if (filled == W) resync();
+        return;
+    }
+
+    // Slide by one frame: frame 0 leaves the past block, frame L moves
+    // from the future block into the past, the new frame joins the future.
+    const int o = 0;
+    const int m = L;
+    double oPast = rowSum(o, 0, L);
+    double oFuture = rowSum(o, L, W);
+    double mPast = rowSum(m, 0, L);
+    double mFuture = rowSum(m, L, W);
+    double mPastRest = mPast - sim(m, o);
+    double nFutureRest = 0.0;
+    for (int j = L + 1; j < W; j++) nFutureRest += newSims[j];
+    double nPastRest = 0.0;
+    for (int i = 1; i < L; i++) nPastRest += newSims[i];
+    double mFutureRest = mFuture - sim(m, m);
+
+    double newPast = pastSum - 2.0 * oPast + sim(o, o) + 2.0 * mPastRest + sim(m, m);
+    double newFuture = futureSum - 2.0 * mFuture + sim(m, m) + 2.0 * nFutureRest + selfSim;
+    double newCross = crossSum - oFuture - mPast + sim(o, m)
+        + nPastRest + mFutureRest + newSims[m];
+
+    // The oldest slot is recycled for the new frame, which becomes index W-1
+    int s = slot(0);
+    head = (head + 1) % W;
+    std::copy(feature, feature + coeffCount, &features[s * coeffCount]);
+    for (int i = 1; i < W; i++) {
+        int other = slot(i - 1);
+        similarity[s * W + other] = newSims[i];
+        similarity[other * W + s] = newSims[i];
+    }
+    similarity[s * W + s] = selfSim;
+
+    pastSum = newPast;
+    futureSum = newFuture;
+    crossSum = newCross;
+    if (++framesSinceResync >= kResyncPeriod * W) resync();
+}
+
+void NoveltyDetector::updatePeakPicking(float deltaTime) {
+    const double blockArea = (double)halfWidth * halfWidth;
+    novelty = static_cast<float>((pastSum + futureSum - 2.0 * crossSum) / (2.0 * blockArea));
+
+    // A boundary is a local maximum above the adaptive threshold, at least
+    // minSectionSeconds after the previous one
+    float threshold = noveltyMean + kThresholdScale * noveltyDeviation + kMinNovelty;
+    if (novelty < previousNovelty && risingNovelty &&
+        previousNovelty > threshold && timeSinceBoundary >= minSectionSeconds) {
+        boundary = true;
+        boundaryCount++;
+        timeSinceBoundary = 0.0f;
+    }
+    risingNovelty = novelty > previousNovelty;
+    previousNovelty = novelty;
+
+    float alpha = 1.0f - expf(-deltaTime / kStatsSeconds);
+    noveltyMean += alpha * (novelty - noveltyMean);
+    noveltyDeviation += alpha * (fabsf(novelty - noveltyMean) - noveltyDeviation);
+}
+
+void NoveltyDetector::process(const float* logMagnitudes, float deltaTime) {
+    boundary = false;
+    if (bandCount == 0 || deltaTime <= 0.0f) return;
+
+    timeSinceBoundary += deltaTime;
+    for (int b = 0; b < bandCount; b++) bandAccum[b] += logMagnitudes[b];
+    accumHops++;
+    accumTime += deltaTime;
+    if (accumTime < featureSeconds) return;
+
+    // Downsample: average the hops into one frame, then MFCC + L2 normalize
+    float feature[64];
+    std::vector<float> heapFeature;
+    float* coeffs = feature;
+    if (coeffCount > 64) {
+        heapFeature.resize(coeffCount);
+        coeffs = heapFeature.data();
+    }
+    float norm = 0.0f;
+    for (int k = 0; k < coeffCount; k++) {
+        const float* basis = &dctMatrix[k * bandCount];
+        float c = 0.0f;
+        for (int b = 0; b < bandCount; b++) c += basis[b] * bandAccum[b];
+        c /= accumHops;
+        coeffs[k] = c;
+        norm += c * c;
+    }
+    norm = norm > 1e-12f ? 1.0f / sqrtf(norm) : 0.0f;
+    for (int k = 0; k < coeffCount; k++) coeffs[k] *= norm;
+
+    float featureTime = accumTime;
+    std::fill(bandAccum.begin(), bandAccum.end(), 0.0f);
+    accumHops = 0;
+    accumTime = 0.0f;
+
+    pushFeature(coeffs);
+    if (filled == windowFrames) updatePeakPicking(featureTime);
+}
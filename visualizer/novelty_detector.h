@@ -0,0 +1,72 @@
+#ifndef NOVELTY_DETECTOR_H
+#define NOVELTY_DETECTOR_H
+
+#include <vector>
+
+// Streaming structural novelty (Foote) over a downsampled MFCC history.
+//
+// Band spectra are averaged into one feature frame every `featureSeconds`,
+// reduced to cepstral coefficients and L2-normalized. The novelty curve is
+// the correlation of the cosine self-similarity matrix with a checkerboard
+// kernel of half-width L centered on the diagonal. The kernel is
+// unweighted, so its three block sums can be slid along the diagonal with
+// O(L) row/column updates per feature frame instead of recomputing O(L^2).
+class NoveltyDetector {
+private:
+    int bandCount;
+    int coeffCount;
+    int halfWidth;        // L, kernel is 2L x 2L feature frames
+    float featureSeconds;
+    float minSectionSeconds;
+
+    std::vector<float> dctMatrix;     // coeffCount x bandCount
+    std::vector<float> bandAccum;
+    int accumHops;
+    float accumTime;
+
+    // Last 2L feature frames and their pairwise similarities, both circular
+    std::vector<float> features;      // window x coeffCount
+    std::vector<float> similarity;    // window x window
+    int windowFrames;
+    int head;                         // slot of the oldest frame
+    int filled;
+
+    double pastSum;    // sum of S over past x past
+    double futureSum;  // sum of S over future x future
+    double crossSum;   // sum of S over past x future
+    int framesSinceResync;
+
+    float novelty;
+    float noveltyMean;
+    float noveltyDeviation;
+    float previousNovelty;
+    bool risingNovelty;
+    float timeSinceBoundary;
+    bool boundary;
+    unsigned int boundaryCount;
+
+    int slot(int index) const { return (head + index) % windowFrames; }
+    float sim(int a, int b) const { return similarity[slot(a) * windowFrames + slot(b)]; }
+    double blockSum(int rowBegin, int rowEnd, int colBegin, int colEnd) const;
+    double rowSum(int row, int colBegin, int colEnd) const;
+    void resync();
+    void pushFeature(const float* feature);
+    void updatePeakPicking(float deltaTime);
+
+public:
+    NoveltyDetector();
+
+    void configure(int bands, int coefficients, float featureHopSeconds, int kernelHalfWidth,
+        float minSectionLength);
+    void reset();
+
+    // Feed one analysis hop of log band magnitudes
+    void process(const float* logMagnitudes, float deltaTime);
+
+    float getNovelty() const { return novelty; }
+    // True on the hop a section boundary was detected
+    bool isBoundary() const { return boundary; }
+    unsigned int getBoundaryCount() const { return boundaryCount; }
+};
+
+#endif // NOVELTY_DETECTOR_H
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include "onset_detector.h"
+
+namespace {
+    const int kNumClasses = static_cast<int>(DrumClass::Count);
+
+    struct RegionSpec {
+        float lowHz, highHz;
+        float thresholdScale, minFlux, refractory, pulseDecay;
+    };
+
+    // Kick fundamentals, snare body/crack, hat and cymbal sizzle. The hat
+    // region is clipped to whatever the highest analyzer band reaches.
+    const RegionSpec kRegionSpecs[kNumClasses] = {
+        {  40.0f,   120.0f, 1.5f, 0.020f, 0.120f, 0.180f },
+        { 180.0f,  1200.0f, 1.6f, 0.015f, 0.100f, 0.140f },
+        { 2500.0f, 20000.0f, 1.8f, 0.010f, 0.050f, 0.080f },
+    };
+}
+
+DrumOnsetDetector::DrumOnsetDetector() : statsTime(0.8f) {
+    for (int i = 0; i < kNumClasses; i++) {
+        Region& r = regions[i];
+        r.firstBand = 0;
+        r.lastBand = -1;
+        r.thresholdScale = kRegionSpecs[i].thresholdScale;
+        r.minFlux = kRegionSpecs[i].minFlux;
+        r.refractory = kRegionSpecs[i].refractory;
+        r.pulseDecay = kRegionSpecs[i].pulseDecay;
+        r.flux = 0.0f;
+        r.mean = 0.0f;
+        r.deviation = 0.0f;
+        r.sinceOnset = 1.0f;
+        r.pulse = 0.0f;
+        r.onset = false;
+        r.count = 0;
+    }
+}
+
+int DrumOnsetDetector::bandForFrequency(const float* bandFrequencies, int numBands, float hz) {
+    int band = 0;
+    while (band < numBands - 1 && bandFrequencies[band] < hz) band++;
+    return band;
+}
+
+void DrumOnsetDetector::configure(const float* bandFrequencies, int numBands) {
+    previous.assign(numBands, 0.0f);
+    for (int i = 0; i < kNumClasses; i++) {
+        regions[i].firstBand = bandForFrequency(bandFrequencies, numBands, kRegionSpecs[i].lowHz);
+        regions[i].lastBand = bandForFrequency(bandFrequencies, numBands, kRegionSpecs[i].highHz);
+    }
+    // Keep the regions disjoint so each band contributes to a single class
+    for (int i = 1; i < kNumClasses; i++) {
+        regions[i].firstBand = std::max(regions[i].firstBand, regions[i - 1].lastBand + 1);
+        regions[i].lastBand = std::max(regions[i].lastBand, regions[i].firstBand);
+    }
+}
+
+void DrumOnsetDetector::process(const float* magnitudes, int numBands, float deltaTime) {
+    if (numBands != static_cast<int>(previous.size()) || deltaTime <= 0.0f) return;
+
+    // Half-wave rectified spectral flux, accumulated per region in one pass
+    float regionFlux[kNumClasses] = {};
+    int region = 0;
+    for (int band = 0; band < numBands; band++) {
+        while (region < kNumClasses && band > regions[region].lastBand) region++;
+        float rise = magnitudes[band] - previous[band];
+        previous[band] = magnitudes[band];
+        if (region < kNumClasses && band >= regions[region].firstBand && rise > 0.0f) {
+            regionFlux[region] += rise;
+        }
+    }
+
+    float statsAlpha = 1.0f - expf(-deltaTime / statsTime);
+    for (int i = 0; i < kNumClasses; i++) {
+        Region& r = regions[i];
+        r.flux = regionFlux[i] / (r.lastBand - r.firstBand + 1);
+        r.sinceOnset += deltaTime;
+
+        // Threshold from the statistics *before* this hop is folded in
+        float threshold = r.mean + r.thresholdScale * r.deviation + r.minFlux;
+        r.onset = r.flux > threshold && r.sinceOnset >= r.refractory;
+
+        r.pulse *= expf(-deltaTime / r.pulseDecay);
+        if (r.onset) {
+            r.sinceOnset = 0.0f;
+            r.count++;
+            r.pulse = std::max(r.pulse, std::min(1.0f, (r.flux - threshold) / threshold + 0.5f));
+        }
+
+        r.mean += statsAlpha * (r.flux - r.mean);
+        r.deviation += statsAlpha * (fabsf(r.flux - r.mean) - r.deviation);
+    }
+}
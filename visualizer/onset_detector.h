@@ -0,0 +1,50 @@
+#ifndef ONSET_DETECTOR_H
+#define ONSET_DETECTOR_H
+
+#include <vector>
+
+enum class DrumClass { Kick, Snare, HiHat, Count };
+
+// Spectral-flux onset detection for kick, snare and hi-hat regions of the
+// shared band spectrum. Every class has its own adaptive threshold
+// (running mean + deviation of its flux) and refractory period, and all
+// three are updated in a single pass over the bands per hop.
+class DrumOnsetDetector {
+private:
+    struct Region {
+        int firstBand;
+        int lastBand;          // inclusive
+        float thresholdScale;  // deviations above the running mean
+        float minFlux;         // floor so silence never triggers
+        float refractory;      // seconds
+        float pulseDecay;      // seconds
+
+        float flux;
+        float mean;
+        float deviation;
+        float sinceOnset;
+        float pulse;
+        bool onset;
+        unsigned int count;
+    };
+
+    Region regions[static_cast<int>(DrumClass::Count)];
+    std::vector<float> previous;
+    float statsTime; // time constant of the adaptive threshold
+
+    static int bandForFrequency(const float* bandFrequencies, int numBands, float hz);
+
+public:
+    DrumOnsetDetector();
+
+    // Map the drum frequency regions onto the analyzer's band centers
+    void configure(const float* bandFrequencies, int numBands);
+    void process(const float* magnitudes, int numBands, float deltaTime);
+
+    bool onset(DrumClass drum) const { return regions[static_cast<int>(drum)].onset; }
+    float pulse(DrumClass drum) const { return regions[static_cast<int>(drum)].pulse; }
+    float flux(DrumClass drum) const { return regions[static_cast<int>(drum)].flux; }
+    unsigned int count(DrumClass drum) const { return regions[static_cast<int>(drum)].count; }
+};
+
+#endif // ONSET_DETECTOR_H
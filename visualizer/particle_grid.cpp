@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cmath>
+#include "particle_grid.h"
+
+ParticleGrid::ParticleGrid() : inverseCellSize(1.0f), columns(1), rows(1) {
+    cellStart.assign(2, 0);
+}
+
+int ParticleGrid::column(float x) const {
+    int c = static_cast<int>(x * inverseCellSize);
+    return c < 0 ? 0 : (c >= columns ? columns - 1 : c);
+}
+
+int ParticleGrid::row(float y) const {
+    int r = static_cast<int>(y * inverseCellSize);
+    return r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+}
+
+void ParticleGrid::build(const float* x, const float* y, int count, float width, float height, float cellSize) {
+    // About one cell per particle at most keeps clearing and scanning the
+    // offsets cheaper than the particles themselves
+    width = (std::max)(width, 1.0f);
+    height = (std::max)(height, 1.0f);
+    cellSize = (std::max)(cellSize, std::sqrt(width * height / (count + 1)));
+    inverseCellSize = 1.0f / cellSize;
+    columns = (std::max)(1, static_cast<int>(std::ceil(width * inverseCellSize)));
+    rows = (std::max)(1, static_cast<int>(std::ceil(height * inverseCellSize)));
+
+    const int cells = columns * rows;
+    cellStart.assign(cells + 1, 0);
+    cellOf.resize(count);
+    sorted.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        int cell = row(y[i]) * columns + column(x[i]);
+        cellOf[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (int c = 0; c < cells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    // Scatter, then shift the offsets back: the scatter advanced every
+    // cell's start to the start of the next one
+    for (int i = 0; i < count; i++) {
+        sorted[cellStart[cellOf[i]]++] = i;
+    }
+    for (int c = cells; c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
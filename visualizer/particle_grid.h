@@ -0,0 +1,52 @@
+#ifndef PARTICLE_GRID_H
+#define PARTICLE_GRID_H
+
+#include <vector>
+
+// Uniform grid over the screen for finding the particles near a point.
+// Rebuilt every frame with a counting sort: particles are counted per cell,
+// the counts are turned into offsets, and the particle indices scattered
+// into one array grouped by cell. There is no per-cell allocation, and the
+// candidates around a point are three short runs of that array per row of
+// cells instead of every other particle.
+class ParticleGrid {
+private:
+    float inverseCellSize;
+    int columns;
+    int rows;
+    std::vector<int> cellStart;   // columns * rows + 1 offsets into `sorted`
+    std::vector<int> cellOf;      // per particle, scratch for build()
+    std::vector<int> sorted;      // particle indices, grouped by cell
+
+    int column(float x) const;
+    int row(float y) const;
+
+public:
+    ParticleGrid();
+
+    // `cellSize` must be at least the largest distance particles interact
+    // over; the grid makes cells larger when there would be many more
+    // cells than particles. Positions off the area go into the border cells.
+    void build(const float* x, const float* y, int count, float width, float height, float cellSize);
+
+    // Calls fn(index) for every particle in the cell of (x, y) and the
+    // eight cells around it, including the particle at (x, y) itself
+    template <typename Fn>
+    void forEachNear(float x, float y, Fn fn) const {
+        const int cx = column(x);
+        const int cy = row(y);
+        const int firstColumn = cx > 0 ? cx - 1 : 0;
+        const int lastColumn = cx < columns - 1 ? cx + 1 : columns - 1;
+        for (int r = cy > 0 ? cy - 1 : 0; r <= cy + 1 && r < rows; r++) {
+            // Neighboring cells of a row are adjacent in `sorted`
+            const int end = cellStart[r * columns + lastColumn + 1];
+            for (int i = cellStart[r * columns + firstColumn]; i < end; i++) {
+                fn(sorted[i]);
+            }
+        }
+    }
+
+    int getCellCount() const { return columns * rows; }
+};
+
+#endif // PARTICLE_GRID_H
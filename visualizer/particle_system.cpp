@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "particle_system.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PARTICLE_USE_SSE2 1
+#endif
+
+namespace {
+    const int kHotArrays = 9;
+    const float kDamping = 0.98f;
+    const float kBounce = 0.9f;
+
+#ifdef PARTICLE_USE_SSE2
+    const float kPi = 3.14159265359f;
+    const float kHalfPi = 1.57079632679f;
+    const float kTwoPi = 6.28318530718f;
+    const float kInvTwoPi = 0.159154943092f;
+
+    inline __m128 select(__m128 mask, __m128 whenFalse, __m128 whenTrue) {
+        return _mm_or_ps(_mm_and_ps(mask, whenTrue), _mm_andnot_ps(mask, whenFalse));
+    }
+
+    inline __m128 floorPs(__m128 a) {
+        // SSE2 has no round instruction: truncate, then step down for negatives
+        __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+    }
+
+    // Same reduction and polynomial as the plasma kernels, |err| < 4e-6
+    inline __m128 sinPoly(__m128 x) {
+        __m128 cycles = _mm_mul_ps(x, _mm_set1_ps(kInvTwoPi));
+        __m128 r = _mm_sub_ps(cycles, floorPs(_mm_add_ps(cycles, _mm_set1_ps(0.5f))));
+        __m128 y = _mm_mul_ps(r, _mm_set1_ps(kTwoPi));
+        y = select(_mm_cmpgt_ps(y, _mm_set1_ps(kHalfPi)), y, _mm_sub_ps(_mm_set1_ps(kPi), y));
+        y = select(_mm_cmplt_ps(y, _mm_set1_ps(-kHalfPi)), y, _mm_sub_ps(_mm_set1_ps(-kPi), y));
+        __m128 y2 = _mm_mul_ps(y, y);
+        __m128 p = _mm_set1_ps(1.0f / 362880.0f);
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(-1.0f / 5040.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f / 120.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(-1.0f / 6.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(p, y);
+    }
+
+    // Four xorshift32 generators side by side, -0.5 .. 0.5
+    inline __m128 nextRandom(__m128i& state) {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        // The top 23 bits as the mantissa of a float in 1 .. 2
+        __m128i bits = _mm_or_si128(_mm_srli_epi32(state, 9), _mm_set1_epi32(0x3F800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.5f));
+    }
+#endif
+}
+
+ParticleSystem::ParticleSystem(int capacity) : capacity((std::max)(capacity, 0)), count(0), particleSize(2.0f) {
+    // Every array starts on a 16-byte boundary and has room for whole blocks of four
+    const int stride = (this->capacity + 3) & ~3;
+    storage.assign(kHotArrays * stride + 4, 0.0f);
+    float* base = storage.data();
+    base += (4 - (reinterpret_cast<std::uintptr_t>(base) / sizeof(float)) % 4) % 4;
+    float** arrays[kHotArrays] = { &x, &y, &vx, &vy, &life, &frequency, &rotation, &rotationSpeed, &scale };
+    for (int i = 0; i < kHotArrays; i++) {
+        *arrays[i] = base + i * stride;
+    }
+    styles.resize(this->capacity);
+
+    const Uint32 seeds[4] = { 0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u };
+    std::copy(seeds, seeds + 4, randomState);
+    stats = ParticleStats();
+}
+
+float ParticleSystem::random() {
+    Uint32 s = randomState[0];
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    randomState[0] = s;
+    return (s >> 8) * (1.0f / 16777216.0f) - 0.5f;
+}
+
+int ParticleSystem::add(float px, float py, const ParticleStyle& style) {
+    if (count >= capacity) return -1;
+    const int i = count++;
+    x[i] = px;
+    y[i] = py;
+    vx[i] = 0.0f;
+    vy[i] = 0.0f;
+    life[i] = 1.0f;
+    frequency[i] = 0.1f;
+    rotation[i] = 0.0f;
+    rotationSpeed[i] = 0.0f;
+    scale[i] = 1.0f;
+    styles[i] = style;
+    return i;
+}
+
+SDL_Color ParticleSystem::getColor(int i) const {
+    SDL_Color color = styles[i].color;
+    color.a = static_cast<Uint8>((std::min)(life[i], 1.0f) * 255.0f);
+    return color;
+}
+
+// Returns the index of the first particle that ran out of life, count if none did
+int ParticleSystem::integrate(const ParticleFrame& frame) {
+    const float drift = frame.audioLevel * 100.0f * 0.05f;
+    const float kick = frame.beat * 600.0f * 0.15f;
+    const float decay = 0.005f * frame.deltaTime * 60.0f;
+    const float grow = frame.snareHit ? 0.4f : 0.0f;
+    const float half = particleSize / 2;
+    const float lowX = half;
+    const float highX = frame.width - half;
+    const float lowY = half;
+    const float highY = frame.height - half;
+    const float dt = frame.deltaTime;
+    int firstDead = count;
+
+    int i = 0;
+#ifdef PARTICLE_USE_SSE2
+    __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(randomState));
+    const __m128 vTime = _mm_set1_ps(frame.time);
+    const __m128 vDrift = _mm_set1_ps(drift);
+    const __m128 vAudio = _mm_set1_ps(frame.audioLevel);
+    const __m128 vKick = _mm_set1_ps(kick);
+    const __m128 vDamping = _mm_set1_ps(kDamping);
+    const __m128 vBounce = _mm_set1_ps(-kBounce);
+    const __m128 vDt = _mm_set1_ps(dt);
+    const __m128 vLowX = _mm_set1_ps(lowX), vHighX = _mm_set1_ps(highX);
+    const __m128 vLowY = _mm_set1_ps(lowY), vHighY = _mm_set1_ps(highY);
+    const __m128 vDecay = _mm_set1_ps(decay);
+    const __m128 vGrow = _mm_set1_ps(grow);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        // Drift along a direction turning at the particle's own frequency
+        __m128 phase = _mm_mul_ps(_mm_load_ps(frequency + i), vTime);
+        __m128 s = sinPoly(phase);
+        __m128 c = sinPoly(_mm_add_ps(phase, _mm_set1_ps(kHalfPi)));
+        __m128 pvx = _mm_add_ps(_mm_load_ps(vx + i),
+            _mm_mul_ps(_mm_add_ps(s, _mm_mul_ps(nextRandom(state), vAudio)), vDrift));
+        __m128 pvy = _mm_add_ps(_mm_load_ps(vy + i),
+            _mm_mul_ps(_mm_add_ps(c, _mm_mul_ps(nextRandom(state), vAudio)), vDrift));
+        if (frame.kickHit) {
+            pvx = _mm_add_ps(pvx, _mm_mul_ps(nextRandom(state), vKick));
+            pvy = _mm_add_ps(pvy, _mm_mul_ps(nextRandom(state), vKick));
+        }
+        pvx = _mm_mul_ps(pvx, vDamping);
+        pvy = _mm_mul_ps(pvy, vDamping);
+
+        // Walls: back inside, and the velocity across them reversed and damped
+        __m128 px = _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(pvx, vDt));
+        __m128 py = _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(pvy, vDt));
+        __m128 outX = _mm_or_ps(_mm_cmplt_ps(px, vLowX), _mm_cmpgt_ps(px, vHighX));
+        __m128 outY = _mm_or_ps(_mm_cmplt_ps(py, vLowY), _mm_cmpgt_ps(py, vHighY));
+        px = _mm_min_ps(_mm_max_ps(px, vLowX), vHighX);
+        py = _mm_min_ps(_mm_max_ps(py, vLowY), vHighY);
+        pvx = select(outX, pvx, _mm_mul_ps(pvx, vBounce));
+        pvy = select(outY, pvy, _mm_mul_ps(pvy, vBounce));
+        _mm_store_ps(x + i, px);
+        _mm_store_ps(y + i, py);
+        _mm_store_ps(vx + i, pvx);
+        _mm_store_ps(vy + i, pvy);
+
+        __m128 l = _mm_max_ps(_mm_sub_ps(_mm_load_ps(life + i), vDecay), zero);
+        _mm_store_ps(life + i, l);
+        int dead = _mm_movemask_ps(_mm_cmple_ps(l, zero));
+        if (dead && firstDead == count) {
+            int lane = 0;
+            while (!(dead & (1 << lane))) lane++;
+            firstDead = i + lane;
+        }
+
+        _mm_store_ps(rotation + i, _mm_add_ps(_mm_load_ps(rotation + i), _mm_mul_ps(_mm_load_ps(rotationSpeed + i), vDt)));
+        __m128 sc = _mm_add_ps(_mm_load_ps(scale + i), vGrow);
+        _mm_store_ps(scale + i, _mm_min_ps(_mm_max_ps(sc, _mm_set1_ps(0.5f)), _mm_set1_ps(2.0f)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(randomState), state);
+#endif
+    for (; i < count; i++) {
+        float phase = frequency[i] * frame.time;
+        vx[i] += (std::sin(phase) + random() * frame.audioLevel) * drift;
+        vy[i] += (std::cos(phase) + random() * frame.audioLevel) * drift;
+        if (frame.kickHit) {
+            vx[i] += random() * kick;
+            vy[i] += random() * kick;
+        }
+        vx[i] *= kDamping;
+        vy[i] *= kDamping;
+
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        if (x[i] < lowX || x[i] > highX) {
+            x[i] = (std::min)((std::max)(x[i], lowX), highX);
+            vx[i] *= -kBounce;
+        }
+        if (y[i] < lowY || y[i] > highY) {
+            y[i] = (std::min)((std::max)(y[i], lowY), highY);
+            vy[i] *= -kBounce;
+        }
+
+        life[i] = (std::max)(life[i] - decay, 0.0f);
+        if (life[i] <= 0.0f && firstDead == count) firstDead = i;
+
+        rotation[i] += rotationSpeed[i] * dt;
+        scale[i] = (std::max)(0.5f, (std::min)(scale[i] + grow, 2.0f));
+    }
+    return firstDead;
+}
+
+// Overlapping particles are pushed apart along the line between their
+// centers and take over the other one's velocity. Only particles in
+// neighboring grid cells are tested; the cells are at least as large as a
+// particle, so nothing that can touch is missed.
+int ParticleSystem::collide(bool kickHit, float width, float height) {
+    grid.build(x, y, count, width, height, particleSize);
+    const float minDistance = particleSize;
+    const float minDistanceSquared = minDistance * minDistance;
+    int collisions = 0;
+
+    for (int i = 0; i < count; i++) {
+        grid.forEachNear(x[i], y[i], [&](int j) {
+            if (j == i) return;
+            float dx = x[i] - x[j];
+            float dy = y[i] - y[j];
+            float distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared >= minDistanceSquared || distanceSquared <= 0.0f) return;
+
+            // Half the overlap along the normalized offset
+            float distance = std::sqrt(distanceSquared);
+            float push = (minDistance - distance) * 0.5f / distance;
+            x[i] += dx * push;
+            y[i] += dy * push;
+
+            vx[i] = vx[j] * kBounce + (kickHit ? random() * 75.0f : 0.0f);
+            vy[i] = vy[j] * kBounce + (kickHit ? random() * 75.0f : 0.0f);
+            collisions++;
+        });
+    }
+    return collisions;
+}
+
+void ParticleSystem::removeDead(int firstDead) {
+    // Stable, so the draw order of the survivors doesn't change
+    float* arrays[kHotArrays] = { x, y, vx, vy, life, frequency, rotation, rotationSpeed, scale };
+    int kept = firstDead;
+    for (int i = firstDead; i < count; i++) {
+        if (life[i] <= 0.0f) continue;
+        for (int a = 0; a < kHotArrays; a++) {
+            arrays[a][kept] = arrays[a][i];
+        }
+        styles[kept] = styles[i];
+        kept++;
+    }
+    count = kept;
+}
+
+void ParticleSystem::update(const ParticleFrame& frame) {
+    auto start = std::chrono::steady_clock::now();
+
+    int firstDead = integrate(frame);
+    particleSize = 2.0f + frame.audioLevel * 7.0f + frame.beat * 5.0f;
+    stats.collisions = collide(frame.kickHit, frame.width, frame.height);
+    if (firstDead < count) removeDead(firstDead);
+    stats.count = count;
+
+    float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.averageMs = stats.averageMs > 0.0f ? stats.averageMs + 0.05f * (elapsedMs - stats.averageMs) : elapsedMs;
+}
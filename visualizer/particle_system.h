@@ -0,0 +1,108 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "particle_grid.h"
+
+enum class ParticleShape { Circle, Rectangle, Star, Triangle, Pentagon, Hexagon };
+enum class ParticlePalette { PLASMA, ICE, VOLCANO, ORANGE, MYSTIC, NEON, AURORA, FOREST, COSMIC, SUNSET };
+
+// What only drawing needs
+struct ParticleStyle {
+    SDL_Color color;      // alpha comes from the life left
+    float maxLife;
+    ParticleShape shape;
+    ParticlePalette palette;
+};
+
+// Everything an update needs besides the particles
+struct ParticleFrame {
+    float audioLevel;
+    float beat;
+    bool kickHit;         // true only on the frame a new drum onset was detected
+    bool snareHit;
+    float deltaTime;
+    float time;           // drives the drift direction
+    float width;          // the walls
+    float height;
+};
+
+struct ParticleStats {
+    int count;
+    int collisions;
+    float averageMs;      // update(), smoothed
+};
+
+// Particles as a structure of arrays. The fields every update reads and
+// writes live in separate 16-byte aligned float arrays of one fixed-capacity
+// block, so integration, damping, wall bounce and life decay run four
+// particles per instruction over contiguous memory; what only drawing
+// reads is kept apart in `styles`. The drift and kick randomness comes
+// from a per-lane xorshift generator instead of rand(). Collisions go
+// through the grid after integration, and dead particles are compacted
+// out in order.
+class ParticleSystem {
+private:
+    int capacity;
+    int count;
+    std::vector<float> storage;
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* life;
+    float* frequency;
+    float* rotation;
+    float* rotationSpeed;
+    float* scale;
+    std::vector<ParticleStyle> styles;
+    float particleSize;   // the same for every particle, set from the audio each update
+
+    ParticleGrid grid;
+    Uint32 randomState[4];
+    ParticleStats stats;
+
+    float random();       // -0.5 .. 0.5
+    int integrate(const ParticleFrame& frame);
+    int collide(bool kickHit, float width, float height);
+    void removeDead(int firstDead);
+
+public:
+    explicit ParticleSystem(int capacity);
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // Adds a particle at rest with full life and returns its index, -1 when
+    // full. Fields beyond position and style are set through the arrays.
+    int add(float px, float py, const ParticleStyle& style);
+    void update(const ParticleFrame& frame);
+    void clear() { count = 0; }
+
+    int size() const { return count; }
+    int getCapacity() const { return capacity; }
+    float getParticleSize() const { return particleSize; }
+
+    float* getX() { return x; }
+    float* getY() { return y; }
+    float* getVX() { return vx; }
+    float* getVY() { return vy; }
+    float* getLife() { return life; }
+    float* getFrequency() { return frequency; }
+    float* getRotation() { return rotation; }
+    float* getRotationSpeed() { return rotationSpeed; }
+    float* getScale() { return scale; }
+    ParticleStyle* getStyles() { return styles.data(); }
+    const float* getX() const { return x; }
+    const float* getY() const { return y; }
+    const float* getLife() const { return life; }
+    const float* getRotation() const { return rotation; }
+    const float* getScale() const { return scale; }
+    const ParticleStyle* getStyles() const { return styles.data(); }
+    // The style color, alpha from the life left
+    SDL_Color getColor(int i) const;
+
+    const ParticleStats& getStats() const { return stats; }
+};
+
+#endif // PARTICLE_SYSTEM_H
@@ -0,0 +1,801 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "plasma.h"
+#include "plasma_kernels.h"
+
+// Declare writeDebugLog as extern to use the implementation from engine.cpp
+extern void writeDebugLog(const std::string& message);
+
+namespace {
+    // Target output bytes per tile, about half a typical L2 slice
+    const int kTileBytes = 64 * 1024;
+    const float kHalfPi = 1.57079632679f;
+    const float kTwoPi = 6.28318530718f;
+
+    // Palette cycling: the field's own hue drift is colorCycle * 40 degrees
+    // per time unit, roughly 10 per second; the bass speeds it up to 5x
+    const float kCycleDegreesPerSecond = 10.0f;
+    const float kCycleBassBoost = 4.0f;
+    const float kCycleBaseBrightness = 0.65f;
+    const float kCycleMaxStep = 0.25f;   // seconds, longer gaps don't jump the palette
+}
+
+SDL_Color plasmaRgb(float hue, float saturation, float brightness, int palette) {
+    SDL_Color rgb;
+
+    switch (palette) {
+    case 0: // Ice and Frost
+        if (hue < 120) {
+            hue = fmodf(hue * 2.5f, 240.0f);
+            saturation = 80.0f + 20.0f * sinf(hue * 0.01f);
+            brightness = 70.0f + 30.0f * cosf(hue * 0.01f);
+        }
+        else if (hue < 240) {
+            hue = fmodf((hue - 120.0f) * 2.0f, 120.0f);
+            saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
+            brightness = 80.0f + 20.0f * cosf(hue * 0.01f);
+        }
+        else {
+            hue = fmodf((hue - 240.0f) * 3.0f, 120.0f);
+            saturation = 100.0f;
+            brightness = 90.0f + 10.0f * sinf(hue * 0.01f);
+        }
+        break;
+
+    case 1: // Deep Blue
+        hue = fmodf(hue * 1.5f, 240.0f);
+        saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
+        brightness = 40.0f + 20.0f * cosf(hue * 0.01f);
+        break;
+
+    case 2: // Smoke Volcano
+        if (hue < 120) {
+            hue = fmodf(hue * 2.0f, 120.0f);
+            saturation = 60.0f + 20.0f * sinf(hue * 0.01f);
+            brightness = 50.0f + 30.0f * cosf(hue * 0.01f);
+        }
+        else {
+            hue = fmodf((hue - 120.0f) * 2.0f, 120.0f);
+            saturation = 80.0f + 10.0f * sinf(hue * 0.01f);
+            brightness = 70.0f + 20.0f * cosf(hue * 0.01f);
+        }
+        break;
+
+    case 3: // Electric Storm
+        hue = fmodf(hue * 2.0f, 360.0f);
+        saturation = 100.0f;
+        brightness = 80.0f + 20.0f * sinf(hue * 0.01f);
+        break;
+
+    case 4: // Toxic Waste
+        hue = fmodf(hue * 1.5f, 120.0f);
+        saturation = 80.0f + 20.0f * sinf(hue * 0.01f);
+        brightness = 60.0f + 30.0f * cosf(hue * 0.01f);
+        break;
+
+    case 5: // Neon Dreams
+        hue = fmodf(hue * 2.5f, 360.0f);
+        saturation = 90.0f + 10.0f * sinf(hue * 0.01f);
+        brightness = 90.0f + 10.0f * cosf(hue * 0.01f);
+        break;
+    }
+
+    // Convert HSB to RGB
+    float r, g, b;
+    int hi = (int)(hue / 60.0f) % 6;
+    float f = hue / 60.0f - hi;
+    float p = brightness * (1.0f - saturation / 100.0f);
+    float q = brightness * (1.0f - f * saturation / 100.0f);
+    float t = brightness * (1.0f - (1.0f - f) * saturation / 100.0f);
+
+    switch (hi) {
+    case 0: r = brightness; g = t; b = p; break;
+    case 1: r = q; g = brightness; b = p; break;
+    case 2: r = p; g = brightness; b = t; break;
+    case 3: r = p; g = q; b = brightness; break;
+    case 4: r = t; g = p; b = brightness; break;
+    case 5: r = brightness; g = p; b = q; break;
+    }
+
+    rgb.r = (Uint8)(r * 255.0f / 100.0f);
+    rgb.g = (Uint8)(g * 255.0f / 100.0f);
+    rgb.b = (Uint8)(b * 255.0f / 100.0f);
+    rgb.a = 255;
+
+    return rgb;
+}
+
+void plasmaSpanScalar(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int xBegin, int xEnd) {
+    const PlasmaFrame& f = k.frame;
+    const float angleShift = k.angleOffset + f.time1;
+
+    for (int x = xBegin; x < xEnd; ++x) {
+        // Swirling transformation with random perturbation, dynamic swirl
+        // modulated by time, audio, and random seed
+        float angle = polar.angle[x] + angleShift + f.swirlFactor * polar.swirl[x];
+        float radius = polar.radius[x] * k.radiusScale;
+
+        float sx = radius * cosf(angle);
+        float sy = radius * sinf(angle);
+
+        // Multiple sine waves with random coefficients for varied patterns
+        float value =
+            0.50f * sinf(sx * k.freqX + f.time1) +
+            0.35f * sinf(sy * k.freqY + f.time2) +
+            0.25f * sinf((sx + sy) * k.freqXY + f.time3) +
+            0.30f * sinf(radius * k.freqR + f.colorCycle);
+        value = (value + 1.0f) * 0.5f;
+
+        // The palettes set saturation and brightness from the hue alone, so
+        // the crossfaded color is a single lookup
+        // Wrapped into [0, 360) like fmodPositive in the SIMD kernels: value
+        // dips below 0 and colorCycle starts at 0, so the sum can be negative
+        float hue = f.colorCycle * 40.0f + value * 120.0f + radius * k.radiusHue;
+        hue -= 360.0f * floorf(hue / 360.0f);
+        int index = std::min((int)(hue * kPlasmaLutScale), kPlasmaLutSize - 1);
+        row[x] = k.colorLut[index];
+    }
+}
+
+void plasmaRowReference(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width) {
+    const PlasmaFrame& f = k.frame;
+    const float keep = 1.0f - f.paletteInterpolation;
+    const float angleShift = k.angleOffset + f.time1;
+
+    for (int x = 0; x < width; ++x) {
+        // Swirling transformation with random perturbation, dynamic swirl
+        // modulated by time, audio, and random seed
+        float angle = polar.angle[x] + angleShift + f.swirlFactor * polar.swirl[x];
+        float radius = polar.radius[x] * k.radiusScale;
+
+        float sx = radius * cosf(angle);
+        float sy = radius * sinf(angle);
+
+        // Multiple sine waves with random coefficients for varied patterns
+        float value =
+            0.50f * sinf(sx * k.freqX + f.time1) +
+            0.35f * sinf(sy * k.freqY + f.time2) +
+            0.25f * sinf((sx + sy) * k.freqXY + f.time3) +
+            0.30f * sinf(radius * k.freqR + f.colorCycle);
+        value = (value + 1.0f) * 0.5f;
+
+        // Dynamic HSB color with audio-reactive brightness
+        float hue = f.colorCycle * 40.0f + value * 120.0f + radius * k.radiusHue;
+        hue -= 360.0f * floorf(hue / 360.0f);
+        float brightness = 20.0f + 60.0f * value + 30.0f * f.audioBassLevel;
+
+        SDL_Color currentColor = plasmaRgb(hue, k.saturation, brightness, f.currentPalette);
+        SDL_Color nextColor = plasmaRgb(hue, k.saturation, brightness, f.nextPalette);
+
+        Uint8 r = (Uint8)(keep * currentColor.r + f.paletteInterpolation * nextColor.r);
+        Uint8 g = (Uint8)(keep * currentColor.g + f.paletteInterpolation * nextColor.g);
+        Uint8 b = (Uint8)(keep * currentColor.b + f.paletteInterpolation * nextColor.b);
+
+        // Write pixel (RGBA8888: assuming little-endian ABGR layout)
+        row[x] = (0xFF << 24) | (b << 16) | (g << 8) | r;
+    }
+}
+
+void plasmaRowScalar(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width) {
+    plasmaSpanScalar(k, polar, row, 0, width);
+}
+
+void plasmaExpandScalar(const Uint8* index, const Uint32* palette, Uint32* row, int width) {
+    for (int x = 0; x < width; ++x) {
+        row[x] = palette[index[x]];
+    }
+}
+
+namespace {
+    PlasmaRowKernel rowKernel(PlasmaKernel kernel) {
+        switch (kernel) {
+#ifdef PLASMA_HAVE_AVX2
+        case PlasmaKernel::AVX2: return plasmaRowAVX2;
+#endif
+#ifdef PLASMA_HAVE_SSE2
+        case PlasmaKernel::SSE2: return plasmaRowSSE2;
+#endif
+        default: return plasmaRowScalar;
+        }
+    }
+
+    PlasmaExpandKernel expandKernel(PlasmaKernel kernel) {
+#ifdef PLASMA_HAVE_AVX2
+        if (kernel == PlasmaKernel::AVX2) return plasmaExpandAVX2;
+#endif
+        // Without a gather instruction SSE2 gains nothing over plain loads
+        return plasmaExpandScalar;
+    }
+
+    PlasmaConstants frameConstants(const PlasmaFrame& frame, int width, int height) {
+        PlasmaConstants k;
+        k.frame = frame;
+        k.aspect = width / (float)height;
+        k.centerX = width / 2.0f;
+        k.centerY = height / 2.0f;
+        k.yScale = 1.0f + 0.2f * frame.shapeSeed;
+        k.angleOffset = 0.5f * sinf(frame.t * 0.1f + frame.shapeSeed);
+        k.swirlBias = 0.3f + 0.2f * frame.shapeSeed;
+        k.radiusScale = 0.8f + 0.3f * sinf(frame.time2 * (0.5f + frame.shapeSeed));
+        k.freqX = 7.0f + 3.0f * frame.shapeSeed;
+        k.freqY = 9.0f + 4.0f * frame.shapeSeed;
+        k.freqXY = 5.0f + 2.0f * frame.shapeSeed;
+        k.freqR = 15.0f + 5.0f * frame.shapeSeed;
+        k.radiusHue = 60.0f + 20.0f * frame.shapeSeed;
+        k.saturation = 70.0f + 30.0f * sinf(frame.time3 + frame.shapeSeed);
+        return k;
+    }
+
+    // plasmaRgb sampled at the center of every LUT entry, for all palettes.
+    // Saturation and brightness are passed as 0, every palette replaces them.
+    const std::vector<SDL_Color>& bakedPalettes() {
+        static const std::vector<SDL_Color> luts = [] {
+            std::vector<SDL_Color> baked(6 * kPlasmaLutSize);
+            for (int palette = 0; palette < 6; palette++) {
+                for (int i = 0; i < kPlasmaLutSize; i++) {
+                    float hue = (i + 0.5f) / kPlasmaLutScale;
+                    baked[palette * kPlasmaLutSize + i] = plasmaRgb(hue, 0.0f, 0.0f, palette);
+                }
+            }
+            return baked;
+        }();
+        return luts;
+    }
+
+    // The per-pixel palette crossfade, done once per LUT entry instead
+    void blendPaletteLut(const PlasmaFrame& frame, std::vector<Uint32>& lut) {
+        const std::vector<SDL_Color>& baked = bakedPalettes();
+        const SDL_Color* current = &baked[frame.currentPalette * kPlasmaLutSize];
+        const SDL_Color* next = &baked[frame.nextPalette * kPlasmaLutSize];
+        const float blend = frame.paletteInterpolation;
+        const float keep = 1.0f - blend;
+
+        lut.resize(kPlasmaLutSize);
+        for (int i = 0; i < kPlasmaLutSize; i++) {
+            Uint8 r = (Uint8)(keep * current[i].r + blend * next[i].r);
+            Uint8 g = (Uint8)(keep * current[i].g + blend * next[i].g);
+            Uint8 b = (Uint8)(keep * current[i].b + blend * next[i].b);
+            // RGBA8888: assuming little-endian ABGR layout
+            lut[i] = (0xFF << 24) | (b << 16) | (g << 8) | r;
+        }
+    }
+
+    int tileRowsFor(int width) {
+        return std::max(1, kTileBytes / (width * 4));
+    }
+
+    // Rebuilds the cache if the resolution or the shape seed changed, the
+    // rows are filled in parallel like the plasma itself
+    void updatePolarCache(ThreadPool& pool, const PlasmaConstants& k, int width, int height,
+        PlasmaPolarCache& cache) {
+        if (cache.width == width && cache.height == height && cache.shapeSeed == k.frame.shapeSeed) return;
+
+        const size_t count = (size_t)width * height;
+        cache.angle.resize(count);
+        cache.radius.resize(count);
+        cache.swirl.resize(count);
+        cache.width = width;
+        cache.height = height;
+        cache.shapeSeed = k.frame.shapeSeed;
+
+        const int tileRows = tileRowsFor(width);
+        const int tiles = (height + tileRows - 1) / tileRows;
+        pool.parallelFor(tiles, [&](int tile) {
+            int rowEnd = std::min(height, (tile + 1) * tileRows);
+            for (int y = tile * tileRows; y < rowEnd; ++y) {
+                float ny = ((y - k.centerY) / k.centerY) * k.yScale;
+                size_t offset = (size_t)y * width;
+                for (int x = 0; x < width; ++x) {
+                    float nx = ((x - k.centerX) / k.centerX) * k.aspect;
+                    float radius = sqrtf(nx * nx + ny * ny);
+                    cache.angle[offset + x] = atan2f(ny, nx);
+                    cache.radius[offset + x] = radius;
+                    cache.swirl[offset + x] = 1.0f / (radius + k.swirlBias);
+                }
+            }
+        });
+    }
+
+    // Evaluates rows firstRow, firstRow + rowStep, ... in tiles of
+    // tileRowsFor(width) rows, optionally only columns [spanBegin[y],
+    // spanEnd[y]) of each; returns how many pixels that was
+    long long renderTiles(ThreadPool& pool, PlasmaRowKernel rowFn, const PlasmaConstants& k,
+        const PlasmaPolarCache& cache, void* pixels, int pitch, int width, int height,
+        int firstRow = 0, int rowStep = 1, const int* spanBegin = nullptr, const int* spanEnd = nullptr) {
+        Uint32* pixelBuffer = static_cast<Uint32*>(pixels);
+        const int pitchPixels = pitch / 4;
+        const int rows = firstRow < height ? (height - firstRow + rowStep - 1) / rowStep : 0;
+        const int tileRows = tileRowsFor(width);
+        const int tiles = (rows + tileRows - 1) / tileRows;
+
+        pool.parallelFor(tiles, [&](int tile) {
+            int rowBegin = tile * tileRows;
+            int rowEnd = std::min(rows, rowBegin + tileRows);
+            for (int i = rowBegin; i < rowEnd; ++i) {
+                int y = firstRow + i * rowStep;
+                int xBegin = spanBegin ? spanBegin[y] : 0;
+                int xEnd = spanEnd ? spanEnd[y] : width;
+                if (xBegin >= xEnd) continue;
+                // The kernels only index the polar arrays and the output, so
+                // a span is just a shorter row starting further in
+                size_t offset = (size_t)y * width + xBegin;
+                PlasmaPolarRow polarRow = { &cache.angle[offset], &cache.radius[offset], &cache.swirl[offset] };
+                rowFn(k, polarRow, pixelBuffer + y * pitchPixels + xBegin, xEnd - xBegin);
+            }
+        });
+
+        if (!spanBegin) return (long long)rows * width;
+        long long evaluated = 0;
+        for (int i = 0; i < rows; ++i) {
+            int y = firstRow + i * rowStep;
+            evaluated += std::max(0, spanEnd[y] - spanBegin[y]);
+        }
+        return evaluated;
+    }
+
+    // Rebuilds the map if the resolution or the fold count changed. Returns
+    // true if it did, the previously evaluated wedge is then useless.
+    //
+    // The fundamental wedge spans 360/folds degrees clockwise from straight
+    // up. A pixel's angle is reduced modulo two wedges and reflected if it
+    // lands in the second, which mirrors neighbouring wedges into each other;
+    // the radius is kept. Sources are rounded to pixels and clamped to the
+    // screen (corner pixels can map past the edge of a narrow wedge).
+    bool updateKaleidoscopeMap(ThreadPool& pool, int width, int height, int folds, PlasmaKaleidoscopeMap& map) {
+        if (map.width == width && map.height == height && map.folds == folds) return false;
+
+        map.source.resize((size_t)width * height);
+        map.spanBegin.assign(height, width);
+        map.spanEnd.assign(height, 0);
+        map.width = width;
+        map.height = height;
+        map.folds = folds;
+
+        const float wedge = kTwoPi / folds;
+        const float wedgeStart = -kHalfPi;
+        const float centerX = width / 2.0f;
+        const float centerY = height / 2.0f;
+
+        const int tileRows = tileRowsFor(width);
+        const int tiles = (height + tileRows - 1) / tileRows;
+        pool.parallelFor(tiles, [&](int tile) {
+            int rowEnd = std::min(height, (tile + 1) * tileRows);
+            for (int y = tile * tileRows; y < rowEnd; ++y) {
+                float dy = y + 0.5f - centerY;
+                for (int x = 0; x < width; ++x) {
+                    float dx = x + 0.5f - centerX;
+                    float radius = sqrtf(dx * dx + dy * dy);
+                    float angle = fmodf(atan2f(dy, dx) - wedgeStart, 2.0f * wedge);
+                    if (angle < 0.0f) angle += 2.0f * wedge;
+                    if (angle > wedge) angle = 2.0f * wedge - angle;
+                    angle += wedgeStart;
+
+                    int sx = (int)floorf(centerX + radius * cosf(angle));
+                    int sy = (int)floorf(centerY + radius * sinf(angle));
+                    sx = std::max(0, std::min(width - 1, sx));
+                    sy = std::max(0, std::min(height - 1, sy));
+                    map.source[(size_t)y * width + x] = (Uint32)sy * width + sx;
+                }
+            }
+        });
+
+        // Every source has to be evaluated: per row, the range they cover.
+        // The wedge is convex, so that range has (almost) no gaps.
+        for (size_t i = 0; i < map.source.size(); i++) {
+            int sy = (int)(map.source[i] / width);
+            int sx = (int)(map.source[i] % width);
+            map.spanBegin[sy] = std::min(map.spanBegin[sy], sx);
+            map.spanEnd[sy] = std::max(map.spanEnd[sy], sx + 1);
+        }
+        return true;
+    }
+
+    void remapPixels(ThreadPool& pool, const PlasmaKaleidoscopeMap& map, const Uint32* wedge,
+        void* pixels, int pitch) {
+        Uint8* destination = static_cast<Uint8*>(pixels);
+        const int width = map.width;
+        const int height = map.height;
+        const int tileRows = tileRowsFor(width);
+        const int tiles = (height + tileRows - 1) / tileRows;
+        pool.parallelFor(tiles, [&](int tile) {
+            int rowEnd = std::min(height, (tile + 1) * tileRows);
+            for (int y = tile * tileRows; y < rowEnd; ++y) {
+                Uint32* row = reinterpret_cast<Uint32*>(destination + (size_t)y * pitch);
+                const Uint32* source = &map.source[(size_t)y * width];
+                for (int x = 0; x < width; ++x) {
+                    row[x] = wedge[source[x]];
+                }
+            }
+        });
+    }
+
+    void copyRows(ThreadPool& pool, const Uint32* source, void* pixels, int pitch, int width, int height) {
+        Uint8* destination = static_cast<Uint8*>(pixels);
+        const int tileRows = tileRowsFor(width);
+        const int tiles = (height + tileRows - 1) / tileRows;
+        pool.parallelFor(tiles, [&](int tile) {
+            int rowEnd = std::min(height, (tile + 1) * tileRows);
+            for (int y = tile * tileRows; y < rowEnd; ++y) {
+                std::memcpy(destination + (size_t)y * pitch, source + (size_t)y * width, width * sizeof(Uint32));
+            }
+        });
+    }
+}
+
+PlasmaRenderer::PlasmaRenderer() : kernel(bestKernel()), engine(PlasmaEngine::Field), interlace(1),
+interlacePhase(0), refreshRequested(true), historyWidth(0), historyHeight(0), folds(0), indexWidth(0),
+indexHeight(0), indexFolds(0), indexSeed(-1.0f), cycleRotation(0.0f), cycleTime(0.0f), fixedWidth(0),
+fixedHeight(0), fixedSeed(-1.0f) {
+}
+
+void PlasmaRenderer::setEngine(PlasmaEngine requested) {
+    engine = requested;
+    // Neither engine keeps the other's history up to date
+    refreshRequested = true;
+    indexWidth = 0;
+}
+
+const char* PlasmaRenderer::engineName(PlasmaEngine engine) {
+    switch (engine) {
+    case PlasmaEngine::PaletteCycle: return "palette cycle";
+    case PlasmaEngine::FixedPoint: return "fixed point";
+    default: return "field";
+    }
+}
+
+bool PlasmaRenderer::parseEngine(const std::string& name, PlasmaEngine& engine) {
+    if (name == "field") engine = PlasmaEngine::Field;
+    else if (name == "cycle") engine = PlasmaEngine::PaletteCycle;
+    else if (name == "fixed") engine = PlasmaEngine::FixedPoint;
+    else return false;
+    return true;
+}
+
+void PlasmaRenderer::setKaleidoscope(int foldCount) {
+    folds = (foldCount == 2 || foldCount == 4 || foldCount == 6 || foldCount == 8) ? foldCount : 0;
+    // The history holds a full image or a wedge, not both
+    refreshRequested = true;
+}
+
+void PlasmaRenderer::setInterlace(int rows) {
+    interlace = std::max(1, std::min(rows, 8));
+    interlacePhase = 0;
+    // Rows in the history may be stale or missing
+    refreshRequested = true;
+}
+
+bool PlasmaRenderer::isSupported(PlasmaKernel kernel) {
+    switch (kernel) {
+    case PlasmaKernel::Scalar:
+        return true;
+    case PlasmaKernel::SSE2:
+#ifdef PLASMA_HAVE_SSE2
+        return SDL_HasSSE2() == SDL_TRUE;
+#else
+        return false;
+#endif
+    case PlasmaKernel::AVX2:
+#ifdef PLASMA_HAVE_AVX2
+        return SDL_HasAVX2() == SDL_TRUE;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+PlasmaKernel PlasmaRenderer::bestKernel() {
+    if (isSupported(PlasmaKernel::AVX2)) return PlasmaKernel::AVX2;
+    if (isSupported(PlasmaKernel::SSE2)) return PlasmaKernel::SSE2;
+    return PlasmaKernel::Scalar;
+}
+
+const char* PlasmaRenderer::kernelName(PlasmaKernel kernel) {
+    switch (kernel) {
+    case PlasmaKernel::SSE2: return "SSE2";
+    case PlasmaKernel::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
+
+void PlasmaRenderer::setKernel(PlasmaKernel requested) {
+    kernel = isSupported(requested) ? requested : bestKernel();
+}
+
+void PlasmaRenderer::render(ThreadPool& pool, const PlasmaFrame& frame, void* pixels, int pitch,
+    int width, int height) {
+    if (!pixels || width <= 0 || height <= 0) return;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    PlasmaConstants k = frameConstants(frame, width, height);
+    blendPaletteLut(frame, frameLut);
+    k.colorLut = frameLut.data();
+    if (engine != PlasmaEngine::FixedPoint) {
+        updatePolarCache(pool, k, width, height, polar);
+    }
+
+    const bool mirrored = folds > 0 && engine != PlasmaEngine::FixedPoint;
+    if (mirrored && updateKaleidoscopeMap(pool, width, height, folds, kaleidoscope)) {
+        refreshRequested = true;
+    }
+
+    long long evaluated;
+    if (engine == PlasmaEngine::PaletteCycle) {
+        evaluated = renderPaletteCycle(pool, k, pixels, pitch, width, height);
+    }
+    else if (engine == PlasmaEngine::FixedPoint) {
+        evaluated = renderFixedPoint(pool, k, pixels, pitch, width, height);
+    }
+    else if (interlace <= 1 && !mirrored) {
+        evaluated = renderTiles(pool, rowKernel(kernel), k, polar, pixels, pitch, width, height);
+    }
+    else {
+        bool fullRefresh = refreshRequested || interlace <= 1 || historyWidth != width || historyHeight != height;
+        if (historyWidth != width || historyHeight != height) {
+            history.assign((size_t)width * height, 0);
+            historyWidth = width;
+            historyHeight = height;
+        }
+        const int* spanBegin = mirrored ? kaleidoscope.spanBegin.data() : nullptr;
+        const int* spanEnd = mirrored ? kaleidoscope.spanEnd.data() : nullptr;
+        if (fullRefresh) {
+            evaluated = renderTiles(pool, rowKernel(kernel), k, polar, history.data(), width * 4, width, height,
+                0, 1, spanBegin, spanEnd);
+            if (interlace > 1) stats.fullRefreshes++;
+        }
+        else {
+            evaluated = renderTiles(pool, rowKernel(kernel), k, polar, history.data(), width * 4, width, height,
+                interlacePhase, interlace, spanBegin, spanEnd);
+        }
+        interlacePhase = (interlacePhase + 1) % interlace;
+
+        if (mirrored) {
+            remapPixels(pool, kaleidoscope, history.data(), pixels, pitch);
+        }
+        else {
+            copyRows(pool, history.data(), pixels, pitch, width, height);
+        }
+    }
+    refreshRequested = false;
+
+    float elapsedMs = (SDL_GetPerformanceCounter() - start) * 1000.0f / SDL_GetPerformanceFrequency();
+    stats.averageMs = stats.frames > 0 ? stats.averageMs + 0.05f * (elapsedMs - stats.averageMs) : elapsedMs;
+    stats.frames++;
+    stats.pixelsEvaluated += evaluated;
+    stats.pixelsDisplayed += (unsigned long long)width * height;
+}
+
+long long PlasmaRenderer::renderPaletteCycle(ThreadPool& pool, const PlasmaConstants& k, void* pixels,
+    int pitch, int width, int height) {
+    const PlasmaFrame& frame = k.frame;
+    long long evaluated = 0;
+
+    if (indexWidth != width || indexHeight != height || indexFolds != folds || indexSeed != frame.shapeSeed) {
+        // The field through a LUT whose entries are their own hue scaled to
+        // 0-255, so the usual kernels produce the index buffer
+        std::vector<Uint32> indexLut(kPlasmaLutSize);
+        for (int i = 0; i < kPlasmaLutSize; i++) {
+            indexLut[i] = (Uint32)(i * 256 / kPlasmaLutSize);
+        }
+        PlasmaConstants snapshot = k;
+        snapshot.colorLut = indexLut.data();
+
+        std::vector<Uint32> hues((size_t)width * height);
+        evaluated = renderTiles(pool, rowKernel(kernel), snapshot, polar, hues.data(), width * 4, width, height);
+
+        indexField.resize(hues.size());
+        for (size_t i = 0; i < hues.size(); i++) {
+            indexField[i] = (Uint8)hues[folds > 0 ? kaleidoscope.source[i] : i];
+        }
+        indexWidth = width;
+        indexHeight = height;
+        indexFolds = folds;
+        indexSeed = frame.shapeSeed;
+        // Start from the colors the snapshot was taken with
+        cycleRotation = 0.0f;
+        cycleTime = frame.t;
+    }
+
+    // The bass spins the palette faster and brightens it
+    float step = frame.t - cycleTime;
+    cycleTime = frame.t;
+    if (step < 0.0f || step > kCycleMaxStep) step = 0.0f;
+    cycleRotation = fmodf(cycleRotation + step * kCycleDegreesPerSecond * (1.0f + kCycleBassBoost * frame.audioBassLevel), 360.0f);
+    const float brightness = kCycleBaseBrightness + (1.0f - kCycleBaseBrightness) * std::min(1.0f, frame.audioBassLevel);
+
+    for (int i = 0; i < 256; i++) {
+        float hue = fmodf((i + 0.5f) * (360.0f / 256.0f) + cycleRotation, 360.0f);
+        Uint32 color = k.colorLut[std::min((int)(hue * kPlasmaLutScale), kPlasmaLutSize - 1)];
+        Uint32 r = (Uint32)((color & 0xFF) * brightness);
+        Uint32 g = (Uint32)(((color >> 8) & 0xFF) * brightness);
+        Uint32 b = (Uint32)(((color >> 16) & 0xFF) * brightness);
+        cyclePalette[i] = (color & 0xFF000000) | (b << 16) | (g << 8) | r;
+    }
+
+    PlasmaExpandKernel expand = expandKernel(kernel);
+    Uint8* destination = static_cast<Uint8*>(pixels);
+    const int tileRows = tileRowsFor(width);
+    const int tiles = (height + tileRows - 1) / tileRows;
+    pool.parallelFor(tiles, [&](int tile) {
+        int rowEnd = std::min(height, (tile + 1) * tileRows);
+        for (int y = tile * tileRows; y < rowEnd; ++y) {
+            expand(&indexField[(size_t)y * width], cyclePalette,
+                reinterpret_cast<Uint32*>(destination + (size_t)y * pitch), width);
+        }
+    });
+    return evaluated;
+}
+
+long long PlasmaRenderer::renderFixedPoint(ThreadPool& pool, const PlasmaConstants& k, void* pixels,
+    int pitch, int width, int height) {
+    if (fixedWidth != width || fixedHeight != height || fixedSeed != k.frame.shapeSeed) {
+        buildFixedRadius(k, width, height, fixedRadius);
+        fixedWidth = width;
+        fixedHeight = height;
+        fixedSeed = k.frame.shapeSeed;
+    }
+
+    // The frame's crossfaded LUT resampled to a power of two
+    fixedLut.resize(kFixedHueSize);
+    for (int i = 0; i < kFixedHueSize; i++) {
+        fixedLut[i] = k.colorLut[i * kPlasmaLutSize / kFixedHueSize];
+    }
+    const PlasmaFixedConstants fc = fixedConstants(k, fixedLut.data());
+
+    Uint8* destination = static_cast<Uint8*>(pixels);
+    const int tileRows = tileRowsFor(width);
+    const int tiles = (height + tileRows - 1) / tileRows;
+    pool.parallelFor(tiles, [&](int tile) {
+        int rowEnd = std::min(height, (tile + 1) * tileRows);
+        for (int y = tile * tileRows; y < rowEnd; ++y) {
+            plasmaRowFixed(fc, &fixedRadius[(size_t)y * width], y,
+                reinterpret_cast<Uint32*>(destination + (size_t)y * pitch), width);
+        }
+    });
+    return (long long)width * height;
+}
+
+bool PlasmaRenderer::runBenchmark(ThreadPool& pool, int width, int height) {
+    // Every kernel is diffed against the exact path: libm per pixel and
+    // plasmaRgb for both palettes. Polynomials and LUT quantization may move
+    // a pixel by a few levels. Pixels sitting on a palette seam (hue wrapping
+    // at 360, piece edges at 120/240) can flip to the other side and differ
+    // a lot, so those are only limited in count.
+    const int kChannelTolerance = 4;
+    const double kMaxOutlierFraction = 0.002;
+    const int kFrames = 8;
+    const PlasmaKernel kernels[] = { PlasmaKernel::Scalar, PlasmaKernel::SSE2, PlasmaKernel::AVX2 };
+    const int kernelCount = 3;
+
+    struct KernelStats {
+        double elapsedMs;
+        long long outliers;
+        int maxDiff;
+    };
+    KernelStats stats[kernelCount] = {};
+    double referenceMs = 0.0;
+    double cacheMs = 0.0;
+
+    std::vector<Uint32> reference(width * height);
+    std::vector<Uint32> candidate(width * height);
+    std::vector<Uint32> lut;
+    PlasmaPolarCache cache;
+
+    for (int i = 0; i < kFrames; i++) {
+        PlasmaFrame f;
+        float t = 1.0f + 7.3f * i;
+        f.t = t;
+        f.shapeSeed = (float)i / kFrames;
+        f.time1 = t * (0.3f + 0.1f * f.shapeSeed);
+        f.time2 = t * (0.5f + 0.2f * f.shapeSeed);
+        f.time3 = t * (0.7f + 0.15f * f.shapeSeed);
+        f.colorCycle = t * (0.2f + 0.1f * f.shapeSeed);
+        f.audioBassLevel = (float)(i % 4) / 3.0f;
+        f.swirlFactor = 0.7f + 0.9f * f.audioBassLevel;
+        f.paletteInterpolation = (float)i / kFrames;
+        f.currentPalette = i % 6;
+        f.nextPalette = (i + 3) % 6;
+
+        PlasmaConstants k = frameConstants(f, width, height);
+        // Every test frame has its own shape seed, so the cache is rebuilt
+        // each time; that cost is reported on its own
+        auto start = std::chrono::steady_clock::now();
+        updatePolarCache(pool, k, width, height, cache);
+        cacheMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        renderTiles(pool, plasmaRowReference, k, cache, reference.data(), width * 4, width, height);
+        referenceMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        for (int n = 0; n < kernelCount; n++) {
+            if (!isSupported(kernels[n])) continue;
+
+            start = std::chrono::steady_clock::now();
+            blendPaletteLut(f, lut);
+            k.colorLut = lut.data();
+            renderTiles(pool, rowKernel(kernels[n]), k, cache, candidate.data(), width * 4, width, height);
+            stats[n].elapsedMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            for (size_t p = 0; p < reference.size(); p++) {
+                int worst = 0;
+                for (int shift = 0; shift < 24; shift += 8) {
+                    int a = (reference[p] >> shift) & 0xFF;
+                    int b = (candidate[p] >> shift) & 0xFF;
+                    worst = std::max(worst, std::abs(a - b));
+                }
+                stats[n].maxDiff = std::max(stats[n].maxDiff, worst);
+                if (worst > kChannelTolerance) stats[n].outliers++;
+            }
+        }
+    }
+
+    writeDebugLog("=== PLASMA KERNEL BENCHMARK (" + std::to_string(width) + "x" + std::to_string(height) +
+        ", " + std::to_string(pool.size()) + " workers) ===");
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "reference (libm + plasmaRgb per pixel): "
+        << referenceMs / kFrames << " ms/frame";
+    writeDebugLog(ss.str());
+
+    bool passed = true;
+    for (int n = 0; n < kernelCount; n++) {
+        if (!isSupported(kernels[n])) {
+            writeDebugLog(std::string(kernelName(kernels[n])) + ": not supported on this CPU");
+            continue;
+        }
+        double elapsedMs = stats[n].elapsedMs / kFrames;
+        double outlierFraction = (double)stats[n].outliers / ((double)reference.size() * kFrames);
+        bool ok = outlierFraction <= kMaxOutlierFraction;
+        passed = passed && ok;
+
+        ss.str("");
+        ss << std::fixed << std::setprecision(2) << kernelName(kernels[n]) << ": " << elapsedMs << " ms/frame ("
+            << referenceMs / kFrames / std::max(elapsedMs, 0.001) << "x reference, "
+            << stats[0].elapsedMs / std::max(stats[n].elapsedMs, 0.001) << "x scalar)"
+            << " | max channel diff " << stats[n].maxDiff
+            << " | " << std::setprecision(4) << outlierFraction * 100.0 << "% pixels off by more than "
+            << kChannelTolerance << " | " << (ok ? "PASS" : "FAIL");
+        writeDebugLog(ss.str());
+    }
+
+    // A different pattern (no swirl), so only timed
+    {
+        PlasmaRenderer fixedPoint;
+        fixedPoint.setEngine(PlasmaEngine::FixedPoint);
+        std::vector<Uint32> image(width * height);
+        PlasmaFrame f = {};
+        f.shapeSeed = 0.5f;
+        f.currentPalette = 1;
+        f.nextPalette = 4;
+        f.paletteInterpolation = 0.5f;
+        fixedPoint.render(pool, f, image.data(), width * 4, width, height);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; i++) {
+            f.t = 1.0f + 7.3f * i;
+            f.time1 = f.t * 0.35f;
+            f.time2 = f.t * 0.6f;
+            f.time3 = f.t * 0.775f;
+            f.colorCycle = f.t * 0.25f;
+            f.audioBassLevel = (float)(i % 4) / 3.0f;
+            fixedPoint.render(pool, f, image.data(), width * 4, width, height);
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kFrames;
+        ss.str("");
+        ss << std::fixed << std::setprecision(2) << "fixed-point engine: " << elapsedMs << " ms/frame ("
+            << stats[0].elapsedMs / kFrames / std::max(elapsedMs, 0.001) << "x scalar field kernel)";
+        writeDebugLog(ss.str());
+    }
+
+    ss.str("");
+    ss << std::fixed << std::setprecision(2) << "polar cache rebuild: "
+        << cacheMs / kFrames << " ms (only on resize or shape change)";
+    writeDebugLog(ss.str());
+    return passed;
+}
@@ -0,0 +1,186 @@
+#ifndef PLASMA_H
+#define PLASMA_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+// HSB (hue 0-360, saturation/brightness 0-100) to RGB through one of the
+// six plasma palettes
+SDL_Color plasmaRgb(float hue, float saturation, float brightness, int palette);
+
+// Everything the plasma field needs for one frame. Filled in on the render
+// thread from the animation state, read-only while the tiles are generated.
+struct PlasmaFrame {
+    float t;
+    float time1, time2, time3;
+    float colorCycle;
+    float shapeSeed;
+    float swirlFactor;
+    float audioBassLevel;
+    float paletteInterpolation;
+    int currentPalette;
+    int nextPalette;
+};
+
+// Polar coordinates of every pixel around the swirl center, one array per
+// field. They depend only on the resolution and the shape seed, so they are
+// built once and reused until either changes.
+struct PlasmaPolarCache {
+    int width;
+    int height;
+    float shapeSeed;
+    std::vector<float> angle;    // atan2(ny, nx)
+    std::vector<float> radius;   // |(nx, ny)|
+    std::vector<float> swirl;    // 1 / (radius + swirl bias)
+
+    PlasmaPolarCache() : width(0), height(0), shapeSeed(-1.0f) {}
+};
+
+// Where every pixel of an N-fold kaleidoscope takes its color from: the
+// index of its mirror image inside the fundamental wedge, and per row the
+// span of columns those images fall in. Depends only on the resolution and
+// the fold count.
+struct PlasmaKaleidoscopeMap {
+    int width;
+    int height;
+    int folds;
+    std::vector<Uint32> source;   // width * height pixel indices
+    std::vector<int> spanBegin;   // per row, empty when spanBegin == spanEnd
+    std::vector<int> spanEnd;
+
+    PlasmaKaleidoscopeMap() : width(0), height(0), folds(0) {}
+};
+
+// Work counters of the amortized modes, since construction
+struct PlasmaStats {
+    unsigned long long frames;
+    unsigned long long pixelsEvaluated;
+    unsigned long long pixelsDisplayed;   // what a full refresh every frame would evaluate
+    unsigned int fullRefreshes;           // forced while interlaced (beats, resizes)
+    float averageMs;                      // smoothed evaluation + upload time
+
+    PlasmaStats() : frames(0), pixelsEvaluated(0), pixelsDisplayed(0), fullRefreshes(0), averageMs(0.0f) {}
+};
+
+struct PlasmaConstants;
+
+// Row kernel implementations, fastest last
+enum class PlasmaKernel { Scalar, SSE2, AVX2 };
+
+// How the picture is produced: the full field every frame, a snapshot of
+// its hues as 8-bit palette indices that only the palette animates, or an
+// integer-only version of the field for CPUs with slow floating point
+enum class PlasmaEngine { Field, PaletteCycle, FixedPoint };
+
+// Generates the plasma background into a locked RGBA8888 texture.
+//
+// The frame is cut into horizontal tiles of a few rows, sized so a tile's
+// output fits in the per-core cache, and the tiles are handed to the thread
+// pool. Every pixel depends only on its coordinates and the frame
+// constants, so the tiles need no synchronization. Rows are evaluated by the
+// widest SIMD kernel the CPU supports, picked once at construction, on top
+// of the polar cache, so the per-frame work is only the time and audio
+// terms. Colors come from palette LUTs baked from plasmaRgb once; the
+// crossfade between two palettes is blended into one LUT per frame.
+//
+// With interlacing set to N > 1 only every Nth row is evaluated per frame,
+// cycling through the N row sets, and the rest are carried over from a
+// persistent copy of the image (locked texture memory is write-only, so it
+// can't hold them). The field drifts slowly enough that rows a few frames
+// old are hard to tell apart; a full refresh can be requested on beats,
+// where the picture jumps.
+//
+// In kaleidoscope mode (2, 4, 6 or 8 folds) the screen is split into that
+// many wedges around the center, each the mirror image of its neighbours.
+// Only the spans covering the fundamental wedge are evaluated, into the same
+// persistent image, and every output pixel is then copied from its source
+// through a precomputed index map, so the field work drops by about the
+// fold count. Interlacing applies to the wedge rows.
+//
+// The palette-cycling engine evaluates the field only when its shape
+// changes (resolution, shape seed, fold count), with a LUT that turns hues
+// into 8-bit indices. Every frame then builds a 256-entry palette from the
+// crossfaded LUT, rotated and brightened by the bass, and expands the index
+// buffer through it, which is a table lookup per pixel.
+//
+// The fixed-point engine (plasma_fixed.cpp) drops the swirl so that the
+// wave phases become integer accumulators along rows and columns, and
+// renders with sine table lookups and adds only. It always renders every
+// pixel; interlacing and the kaleidoscope apply to the field engine.
+class PlasmaRenderer {
+private:
+    PlasmaKernel kernel;
+    PlasmaEngine engine;
+    PlasmaPolarCache polar;
+    std::vector<Uint32> frameLut;
+
+    int interlace;
+    int interlacePhase;
+    bool refreshRequested;
+    std::vector<Uint32> history;
+    int historyWidth;
+    int historyHeight;
+    int folds;
+    PlasmaKaleidoscopeMap kaleidoscope;
+
+    std::vector<Uint8> indexField;
+    int indexWidth;
+    int indexHeight;
+    int indexFolds;
+    float indexSeed;
+    float cycleRotation;    // degrees
+    float cycleTime;        // frame time of the last rotation step
+    Uint32 cyclePalette[256];
+
+    std::vector<Uint16> fixedRadius;
+    std::vector<Uint32> fixedLut;
+    int fixedWidth;
+    int fixedHeight;
+    float fixedSeed;
+    PlasmaStats stats;
+
+    long long renderPaletteCycle(ThreadPool& pool, const PlasmaConstants& k, void* pixels, int pitch,
+        int width, int height);
+    long long renderFixedPoint(ThreadPool& pool, const PlasmaConstants& k, void* pixels, int pitch,
+        int width, int height);
+
+public:
+    PlasmaRenderer();
+
+    void render(ThreadPool& pool, const PlasmaFrame& frame, void* pixels, int pitch,
+        int width, int height);
+
+    // Evaluate 1/rows of the rows per frame, 1 renders every row every frame
+    void setInterlace(int rows);
+    int getInterlace() const { return interlace; }
+    // Mirror the field into 2, 4, 6 or 8 wedges, anything else turns it off
+    void setKaleidoscope(int foldCount);
+    int getKaleidoscope() const { return folds; }
+    // Evaluate every row on the next frame
+    void requestFullRefresh() { refreshRequested = true; }
+    const PlasmaStats& getStats() const { return stats; }
+
+    void setEngine(PlasmaEngine requested);
+    PlasmaEngine getEngine() const { return engine; }
+    static const char* engineName(PlasmaEngine engine);
+    // "field", "cycle" or "fixed"; false leaves `engine` unchanged
+    static bool parseEngine(const std::string& name, PlasmaEngine& engine);
+
+    // Falls back to the best supported kernel if `requested` isn't available
+    void setKernel(PlasmaKernel requested);
+    PlasmaKernel getKernel() const { return kernel; }
+
+    static bool isSupported(PlasmaKernel kernel);
+    static PlasmaKernel bestKernel();
+    static const char* kernelName(PlasmaKernel kernel);
+
+    // Times every supported kernel at the given size against an exact
+    // per-pixel reference, checks their images stay within tolerance of it
+    // and writes the results to the debug log. Returns false if any kernel
+    // fails the diff.
+    static bool runBenchmark(ThreadPool& pool, int width, int height);
+};
+
+#endif // PLASMA_H
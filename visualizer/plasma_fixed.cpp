@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include "plasma_kernels.h"
+
+// The integer plasma engine for CPUs with slow floating point. The four
+// sine waves of the field are kept, but the swirl is left out, which makes
+// the phase of every wave except the radial one a linear function of x and
+// y. A frame is then a 32-bit phase per wave (one full turn wraps at 2^32)
+// with a per-column and a per-row step: each row starts its accumulators
+// at origin + y * row step and then only adds the column steps.
+// The radial wave and the radial hue shift come from a 16-bit radius per
+// pixel that depends only on the resolution and the shape seed. The sine
+// tables are pre-scaled by each wave's weight in hue units, so the pixel's
+// hue is the sum of the lookups and indexes a 4096-entry LUT with a mask.
+// The bass wobbles the rows sideways where the field engine swirls.
+//
+// Floats are only used once per frame to set up the steps and once per
+// resize to build the radius table.
+
+namespace {
+    const double kTwoPiD = 6.283185307179586;
+    const double kTurn = 4294967296.0;   // 2^32, one wrapped phase turn
+
+    const float kWaveWeights[kFixedWaveCount] = { 0.50f, 0.35f, 0.25f, 0.30f };
+    // value * 120 degrees, value = (sum + 1) / 2, in 4096ths of a turn
+    const float kHueUnitsPerValue = 60.0f * kFixedHueSize / 360.0f;
+    const int kHueValueBias = (int)(kHueUnitsPerValue + 0.5f);
+    const float kRadiusUnits = 4096.0f;   // radius table fixed point
+    const float kWobbleTurns = 0.08f;     // row shift at full bass
+
+    struct SineTables {
+        Sint16 wave[kFixedWaveCount][kFixedSineSize];
+        Sint16 unit[kFixedSineSize];      // +-4096, for the wobble
+    };
+
+    const SineTables& sineTables() {
+        static const SineTables tables = [] {
+            SineTables t;
+            for (int i = 0; i < kFixedSineSize; i++) {
+                double s = sin(kTwoPiD * i / kFixedSineSize);
+                for (int w = 0; w < kFixedWaveCount; w++) {
+                    t.wave[w][i] = (Sint16)floor(s * kWaveWeights[w] * kHueUnitsPerValue + 0.5);
+                }
+                t.unit[i] = (Sint16)floor(s * 4096.0 + 0.5);
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    // An angle in radians as a wrapped phase
+    Uint32 toPhase(double radians) {
+        double turns = radians / kTwoPiD;
+        turns -= floor(turns);
+        return (Uint32)(turns * kTurn);
+    }
+
+    // A (small, possibly negative) phase increment
+    Uint32 toStep(double radians) {
+        return (Uint32)(Sint32)floor(radians / kTwoPiD * kTurn + 0.5);
+    }
+
+    // Phase of freq * (a * nx + b * ny) + offset at pixel (0, 0) and per step
+    PlasmaFixedWave linearWave(const PlasmaConstants& k, double freq, double a, double b, double offset) {
+        // nx = (x - cx) / cx * aspect, ny = (y - cy) / cy * yScale
+        double perX = freq * a * k.aspect / k.centerX;
+        double perY = freq * b * k.yScale / k.centerY;
+        PlasmaFixedWave wave;
+        wave.origin = toPhase(offset - perX * k.centerX - perY * k.centerY);
+        wave.stepX = toStep(perX);
+        wave.stepY = toStep(perY);
+        return wave;
+    }
+}
+
+void buildFixedRadius(const PlasmaConstants& k, int width, int height, std::vector<Uint16>& radius) {
+    radius.resize((size_t)width * height);
+    for (int y = 0; y < height; ++y) {
+        float ny = ((y - k.centerY) / k.centerY) * k.yScale;
+        for (int x = 0; x < width; ++x) {
+            float nx = ((x - k.centerX) / k.centerX) * k.aspect;
+            radius[(size_t)y * width + x] = (Uint16)std::min(65535.0f, sqrtf(nx * nx + ny * ny) * kRadiusUnits + 0.5f);
+        }
+    }
+}
+
+PlasmaFixedConstants fixedConstants(const PlasmaConstants& k, const Uint32* hueLut) {
+    const PlasmaFrame& f = k.frame;
+    // The whole picture rotates by the angle the field adds to every pixel
+    const double rotation = k.angleOffset + f.time1;
+    const double c = cos(rotation) * k.radiusScale;
+    const double s = sin(rotation) * k.radiusScale;
+
+    PlasmaFixedConstants fc;
+    // sx = c * nx - s * ny, sy = s * nx + c * ny
+    fc.waveX = linearWave(k, k.freqX, c, -s, f.time1);
+    fc.waveY = linearWave(k, k.freqY, s, c, f.time2);
+    fc.waveXY = linearWave(k, k.freqXY, c + s, c - s, f.time3);
+    fc.radialOrigin = toPhase(f.colorCycle);
+    fc.radialStep = (Uint32)floor(k.freqR * k.radiusScale / kTwoPiD * kTurn / kRadiusUnits + 0.5);
+    fc.radialHueStep = (Uint32)floor(k.radiusScale * k.radiusHue * (kFixedHueSize / 360.0) / kRadiusUnits * 65536.0 + 0.5);
+    fc.hueBase = (int)(fmod(f.colorCycle * 40.0, 360.0) * kFixedHueSize / 360.0) + kHueValueBias;
+    fc.wobbleOrigin = toPhase(f.t * 1.7);
+    fc.wobbleStep = toStep(kTwoPiD * 3.0 / std::max(1.0f, 2.0f * k.centerY));
+    fc.wobbleAmplitude = (Sint32)(std::min(1.0f, f.audioBassLevel) * kWobbleTurns * kTurn / 4096.0);
+    fc.hueLut = hueLut;
+    return fc;
+}
+
+void plasmaRowFixed(const PlasmaFixedConstants& fc, const Uint16* radius, int y, Uint32* row, int width) {
+    const SineTables& tables = sineTables();
+    const Sint16* waveX = tables.wave[0];
+    const Sint16* waveY = tables.wave[1];
+    const Sint16* waveXY = tables.wave[2];
+    const Sint16* waveR = tables.wave[3];
+    const int shift = 32 - kFixedSineBits;
+    const Uint32 uy = (Uint32)y;
+
+    // Row setup: the bass shifts the whole row along the X waves
+    Uint32 wobble = (Uint32)((Sint64)tables.unit[(fc.wobbleOrigin + uy * fc.wobbleStep) >> shift] * fc.wobbleAmplitude);
+    Uint32 phaseX = fc.waveX.origin + uy * fc.waveX.stepY + wobble;
+    Uint32 phaseY = fc.waveY.origin + uy * fc.waveY.stepY;
+    Uint32 phaseXY = fc.waveXY.origin + uy * fc.waveXY.stepY + wobble;
+
+    for (int x = 0; x < width; ++x) {
+        Uint32 r = radius[x];
+        int hue = fc.hueBase + waveX[phaseX >> shift] + waveY[phaseY >> shift] + waveXY[phaseXY >> shift]
+            + waveR[(fc.radialOrigin + r * fc.radialStep) >> shift] + (int)((r * fc.radialHueStep) >> 16);
+        row[x] = fc.hueLut[(unsigned)hue & (kFixedHueSize - 1)];
+        phaseX += fc.waveX.stepX;
+        phaseY += fc.waveY.stepX;
+        phaseXY += fc.waveXY.stepX;
+    }
+}
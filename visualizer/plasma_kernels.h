@@ -0,0 +1,101 @@
+#ifndef PLASMA_KERNELS_H
+#define PLASMA_KERNELS_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "plasma.h"
+
+// Internal to the plasma renderer: per-frame constants and the row kernels
+// that evaluate the field with them. All kernels write one row of packed
+// RGBA8888 pixels and must agree with the reference one to within the
+// tolerance checked by PlasmaRenderer::runBenchmark.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PLASMA_HAVE_SSE2 1
+#endif
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__AVX2__)
+#define PLASMA_HAVE_AVX2 1
+#endif
+
+// Entries in a palette LUT, 24 KB packed so the frame's LUT stays in L1.
+// Each covers 360/6144 degrees of hue, so the palette range edges at 120
+// and 240 degrees fall exactly between entries.
+const int kPlasmaLutSize = 6144;
+const float kPlasmaLutScale = kPlasmaLutSize / 360.0f;
+
+// Per-frame terms of the plasma formula, hoisted out of the pixel loop
+struct PlasmaConstants {
+    PlasmaFrame frame;
+    float aspect;
+    float centerX, centerY;
+    float yScale;          // vertical stretch from the shape seed
+    float angleOffset;     // slow global rotation
+    float swirlBias;       // keeps the swirl finite at the center
+    float radiusScale;     // breathing
+    float freqX, freqY, freqXY, freqR;
+    float radiusHue;
+    float saturation;
+    const Uint32* colorLut;   // kPlasmaLutSize packed pixels, both palettes crossfaded
+};
+
+// One row of the polar cache
+struct PlasmaPolarRow {
+    const float* angle;
+    const float* radius;
+    const float* swirl;
+};
+
+typedef void (*PlasmaRowKernel)(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width);
+
+void plasmaRowScalar(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width);
+void plasmaSpanScalar(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int xBegin, int xEnd);
+// Exact per-pixel plasmaRgb colors, the reference the LUT kernels are checked against
+void plasmaRowReference(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width);
+#ifdef PLASMA_HAVE_SSE2
+void plasmaRowSSE2(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width);
+#endif
+#ifdef PLASMA_HAVE_AVX2
+void plasmaRowAVX2(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width);
+#endif
+
+// Palette-cycling expand: one row of 8-bit indices to packed pixels
+typedef void (*PlasmaExpandKernel)(const Uint8* index, const Uint32* palette, Uint32* row, int width);
+
+void plasmaExpandScalar(const Uint8* index, const Uint32* palette, Uint32* row, int width);
+#ifdef PLASMA_HAVE_AVX2
+void plasmaExpandAVX2(const Uint8* index, const Uint32* palette, Uint32* row, int width);
+#endif
+
+// Fixed-point engine: 1024-entry sine tables indexed by the top bits of
+// wrapped 32-bit phases, and a 4096-entry hue LUT
+const int kFixedSineBits = 10;
+const int kFixedSineSize = 1 << kFixedSineBits;
+const int kFixedHueSize = 4096;
+const int kFixedWaveCount = 4;
+
+// A wave whose phase is origin + x * stepX + y * stepY, wrapping at 2^32
+struct PlasmaFixedWave {
+    Uint32 origin;
+    Uint32 stepX;
+    Uint32 stepY;
+};
+
+struct PlasmaFixedConstants {
+    PlasmaFixedWave waveX, waveY, waveXY;
+    Uint32 radialOrigin;     // phase of the radial wave at the center
+    Uint32 radialStep;       // phase per radius table unit
+    Uint32 radialHueStep;    // 16.16 hue units per radius table unit
+    int hueBase;
+    Uint32 wobbleOrigin;
+    Uint32 wobbleStep;       // per row
+    Sint32 wobbleAmplitude;  // phase per unit of the +-4096 sine table
+    const Uint32* hueLut;    // kFixedHueSize packed pixels
+};
+
+// 16-bit fixed-point distance of every pixel from the center, rebuilt only
+// when the resolution or the shape seed changes
+void buildFixedRadius(const PlasmaConstants& k, int width, int height, std::vector<Uint16>& radius);
+PlasmaFixedConstants fixedConstants(const PlasmaConstants& k, const Uint32* hueLut);
+void plasmaRowFixed(const PlasmaFixedConstants& fc, const Uint16* radius, int y, Uint32* row, int width);
+
+#endif // PLASMA_KERNELS_H
@@ -0,0 +1,181 @@
+#include "plasma_kernels.h"
+
+#if defined(PLASMA_HAVE_SSE2) || defined(PLASMA_HAVE_AVX2)
+#include <immintrin.h>
+
+// SIMD versions of plasmaRowScalar. One template kernel is instantiated for
+// 4-wide SSE2 and 8-wide AVX2 lanes; the libm calls are replaced by
+// polynomials with bounded error:
+//   sin/cos: reduction to [-pi/2, pi/2], degree-9 odd polynomial, |err| < 4e-6
+// atan2 and the swirl division come precomputed from the polar cache, and
+// colors are gathered from the frame's crossfaded palette LUT, so four or
+// eight finished pixels are stored at once.
+
+namespace {
+    const float kPi = 3.14159265359f;
+    const float kHalfPi = 1.57079632679f;
+    const float kTwoPi = 6.28318530718f;
+    const float kInvTwoPi = 0.159154943092f;
+
+#ifdef PLASMA_HAVE_SSE2
+    struct Sse2 {
+        typedef __m128 F;
+        typedef __m128i I;
+        enum { Width = 4 };
+
+        static F set(float v) { return _mm_set1_ps(v); }
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm_div_ps(a, b); }
+        static F bitAnd(F a, F b) { return _mm_and_ps(a, b); }
+        static F bitOr(F a, F b) { return _mm_or_ps(a, b); }
+        static F gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static F ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+        static F lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+        static F eq(F a, F b) { return _mm_cmpeq_ps(a, b); }
+        static F select(F mask, F whenFalse, F whenTrue) {
+            return _mm_or_ps(_mm_and_ps(mask, whenTrue), _mm_andnot_ps(mask, whenFalse));
+        }
+        static F floor(F a) {
+            // SSE2 has no round instruction: truncate, then step down for negatives
+            F truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+            return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+        }
+        static F min(F a, F b) { return _mm_min_ps(a, b); }
+        static I toInt(F a) { return _mm_cvttps_epi32(a); }
+        static I gather(const Uint32* table, I index) {
+            // No gather instruction before AVX2
+            alignas(16) int lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+            return _mm_setr_epi32((int)table[lanes[0]], (int)table[lanes[1]],
+                (int)table[lanes[2]], (int)table[lanes[3]]);
+        }
+        static void store(Uint32* dst, I v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v); }
+    };
+#endif
+
+#ifdef PLASMA_HAVE_AVX2
+    struct Avx2 {
+        typedef __m256 F;
+        typedef __m256i I;
+        enum { Width = 8 };
+
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm256_div_ps(a, b); }
+        static F bitAnd(F a, F b) { return _mm256_and_ps(a, b); }
+        static F bitOr(F a, F b) { return _mm256_or_ps(a, b); }
+        static F gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static F ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static F lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static F eq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static F select(F mask, F whenFalse, F whenTrue) { return _mm256_blendv_ps(whenFalse, whenTrue, mask); }
+        static F floor(F a) { return _mm256_floor_ps(a); }
+        static F min(F a, F b) { return _mm256_min_ps(a, b); }
+        static I toInt(F a) { return _mm256_cvttps_epi32(a); }
+        static I gather(const Uint32* table, I index) {
+            return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4);
+        }
+        static void store(Uint32* dst, I v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v); }
+    };
+#endif
+
+    template <class V>
+    inline typename V::F sinPoly(typename V::F x) {
+        typedef typename V::F F;
+        // Wrap to [-pi, pi), then fold into [-pi/2, pi/2]
+        F cycles = V::mul(x, V::set(kInvTwoPi));
+        F r = V::sub(cycles, V::floor(V::add(cycles, V::set(0.5f))));
+        F y = V::mul(r, V::set(kTwoPi));
+        y = V::select(V::gt(y, V::set(kHalfPi)), y, V::sub(V::set(kPi), y));
+        y = V::select(V::lt(y, V::set(-kHalfPi)), y, V::sub(V::set(-kPi), y));
+        F y2 = V::mul(y, y);
+        F p = V::set(1.0f / 362880.0f);
+        p = V::add(V::mul(p, y2), V::set(-1.0f / 5040.0f));
+        p = V::add(V::mul(p, y2), V::set(1.0f / 120.0f));
+        p = V::add(V::mul(p, y2), V::set(-1.0f / 6.0f));
+        p = V::add(V::mul(p, y2), V::set(1.0f));
+        return V::mul(p, y);
+    }
+
+    template <class V>
+    inline typename V::F cosPoly(typename V::F x) {
+        return sinPoly<V>(V::add(x, V::set(kHalfPi)));
+    }
+
+    template <class V>
+    inline typename V::F fmodPositive(typename V::F x, typename V::F period) {
+        return V::sub(x, V::mul(V::floor(V::div(x, period)), period));
+    }
+
+    template <class V>
+    void plasmaRowSimd(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width) {
+        typedef typename V::F F;
+        const PlasmaFrame& fr = k.frame;
+
+        const F angleShift = V::set(k.angleOffset + fr.time1);
+        const F swirlFactor = V::set(fr.swirlFactor);
+        const F radiusScale = V::set(k.radiusScale);
+        const F lutScale = V::set(kPlasmaLutScale);
+        const F lutLast = V::set((float)(kPlasmaLutSize - 1));
+
+        const int simdEnd = width - width % V::Width;
+        for (int x = 0; x < simdEnd; x += V::Width) {
+            // Swirl in polar coordinates
+            F angle = V::add(V::add(V::load(polar.angle + x), angleShift),
+                V::mul(swirlFactor, V::load(polar.swirl + x)));
+            F radius = V::mul(V::load(polar.radius + x), radiusScale);
+
+            F sx = V::mul(radius, cosPoly<V>(angle));
+            F sy = V::mul(radius, sinPoly<V>(angle));
+
+            F value = V::mul(V::set(0.50f), sinPoly<V>(V::add(V::mul(sx, V::set(k.freqX)), V::set(fr.time1))));
+            value = V::add(value, V::mul(V::set(0.35f), sinPoly<V>(V::add(V::mul(sy, V::set(k.freqY)), V::set(fr.time2)))));
+            value = V::add(value, V::mul(V::set(0.25f), sinPoly<V>(V::add(V::mul(V::add(sx, sy), V::set(k.freqXY)), V::set(fr.time3)))));
+            value = V::add(value, V::mul(V::set(0.30f), sinPoly<V>(V::add(V::mul(radius, V::set(k.freqR)), V::set(fr.colorCycle)))));
+            value = V::mul(V::add(value, V::set(1.0f)), V::set(0.5f));
+
+            F hue = V::add(V::set(fr.colorCycle * 40.0f), V::mul(value, V::set(120.0f)));
+            hue = fmodPositive<V>(V::add(hue, V::mul(radius, V::set(k.radiusHue))), V::set(360.0f));
+
+            typename V::I index = V::toInt(V::min(V::mul(hue, lutScale), lutLast));
+            V::store(row + x, V::gather(k.colorLut, index));
+        }
+
+        if (simdEnd < width) {
+            plasmaSpanScalar(k, polar, row, simdEnd, width);
+        }
+    }
+}
+
+#ifdef PLASMA_HAVE_SSE2
+void plasmaRowSSE2(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width) {
+    plasmaRowSimd<Sse2>(k, polar, row, width);
+}
+#endif
+
+#ifdef PLASMA_HAVE_AVX2
+void plasmaRowAVX2(const PlasmaConstants& k, const PlasmaPolarRow& polar, Uint32* row, int width) {
+    plasmaRowSimd<Avx2>(k, polar, row, width);
+}
+
+// Eight indices widened to 32 bits and gathered from the palette at once
+void plasmaExpandAVX2(const Uint8* index, const Uint32* palette, Uint32* row, int width) {
+    const int simdEnd = width - width % 8;
+    for (int x = 0; x < simdEnd; x += 8) {
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(index + x)));
+        __m256i pixels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), lanes, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + x), pixels);
+    }
+    for (int x = simdEnd; x < width; ++x) {
+        row[x] = palette[index[x]];
+    }
+}
+#endif
+
+#endif // PLASMA_HAVE_SSE2 || PLASMA_HAVE_AVX2
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "point_cloud.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define POINT_CLOUD_USE_SSE2 1
+#endif
+
+namespace {
+    const int kDepthBuckets = 4096;
+    const int kChunkPoints = 16384;   // per worker item, for the transform and the sprites
+}
+
+Matrix4 Matrix4::identity() {
+    Matrix4 r = {};
+    for (int i = 0; i < 4; i++) r.m[i][i] = 1.0f;
+    return r;
+}
+
+Matrix4 Matrix4::translation(const Vector3D& offset) {
+    Matrix4 r = identity();
+    r.m[0][3] = offset.x;
+    r.m[1][3] = offset.y;
+    r.m[2][3] = offset.z;
+    return r;
+}
+
+Matrix4 Matrix4::rotationX(float angle) {
+    Matrix4 r = identity();
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    r.m[1][1] = c;
+    r.m[1][2] = -s;
+    r.m[2][1] = s;
+    r.m[2][2] = c;
+    return r;
+}
+
+Matrix4 Matrix4::rotationY(float angle) {
+    Matrix4 r = identity();
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    r.m[0][0] = c;
+    r.m[0][2] = s;
+    r.m[2][0] = -s;
+    r.m[2][2] = c;
+    return r;
+}
+
+Matrix4 Matrix4::perspective(float focal, float centerX, float centerY) {
+    Matrix4 r = {};
+    r.m[0][0] = focal;
+    r.m[0][2] = centerX;
+    r.m[1][1] = focal;
+    r.m[1][2] = centerY;
+    r.m[2][2] = 1.0f;
+    r.m[3][2] = 1.0f;
+    return r;
+}
+
+Matrix4 Matrix4::operator*(const Matrix4& other) const {
+    Matrix4 r;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            r.m[i][j] = m[i][0] * other.m[0][j] + m[i][1] * other.m[1][j] + m[i][2] * other.m[2][j] +
+                m[i][3] * other.m[3][j];
+        }
+    }
+    return r;
+}
+
+void transformPoints(const Matrix4& m, const float* x, const float* y, const float* z, int count,
+    float* sx, float* sy, float* depth) {
+    int i = 0;
+#ifdef POINT_CLOUD_USE_SSE2
+    const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]);
+    const __m128 m02 = _mm_set1_ps(m.m[0][2]), m03 = _mm_set1_ps(m.m[0][3]);
+    const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]);
+    const __m128 m12 = _mm_set1_ps(m.m[1][2]), m13 = _mm_set1_ps(m.m[1][3]);
+    const __m128 m30 = _mm_set1_ps(m.m[3][0]), m31 = _mm_set1_ps(m.m[3][1]);
+    const __m128 m32 = _mm_set1_ps(m.m[3][2]), m33 = _mm_set1_ps(m.m[3][3]);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        __m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m00), _mm_mul_ps(vy, m01)),
+            _mm_add_ps(_mm_mul_ps(vz, m02), m03));
+        __m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m10), _mm_mul_ps(vy, m11)),
+            _mm_add_ps(_mm_mul_ps(vz, m12), m13));
+        __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m30), _mm_mul_ps(vy, m31)),
+            _mm_add_ps(_mm_mul_ps(vz, m32), m33));
+        __m128 inverse = _mm_div_ps(one, w);
+        _mm_storeu_ps(sx + i, _mm_mul_ps(cx, inverse));
+        _mm_storeu_ps(sy + i, _mm_mul_ps(cy, inverse));
+        _mm_storeu_ps(depth + i, w);
+    }
+#endif
+    for (; i < count; i++) {
+        float cx = x[i] * m.m[0][0] + y[i] * m.m[0][1] + z[i] * m.m[0][2] + m.m[0][3];
+        float cy = x[i] * m.m[1][0] + y[i] * m.m[1][1] + z[i] * m.m[1][2] + m.m[1][3];
+        float w = x[i] * m.m[3][0] + y[i] * m.m[3][1] + z[i] * m.m[3][2] + m.m[3][3];
+        float inverse = 1.0f / w;
+        sx[i] = cx * inverse;
+        sy[i] = cy * inverse;
+        depth[i] = w;
+    }
+}
+
+PointCloud::PointCloud() {
+    stats = PointCloudStats();
+}
+
+void PointCloud::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    colors.clear();
+}
+
+int PointCloud::allocate(int count) {
+    int first = size();
+    x.resize(first + count);
+    y.resize(first + count);
+    z.resize(first + count);
+    colors.resize(first + count);
+    return first;
+}
+
+void PointCloud::render(ThreadPool& pool, const Matrix4& transform, int width, int height, float pointSize,
+    float nearDepth, float farDepth, float farAlpha) {
+    const int count = size();
+    stats = PointCloudStats();
+    stats.points = count;
+    screenX.resize(count);
+    screenY.resize(count);
+    depth.resize(count);
+    keys.resize(count);
+
+    // Project and bucket by depth, far to near
+    auto start = std::chrono::steady_clock::now();
+    const float bucketScale = kDepthBuckets / (farDepth - nearDepth);
+    const int transformChunks = (count + kChunkPoints - 1) / kChunkPoints;
+    pool.parallelFor(transformChunks, [&](int chunk) {
+        const int first = chunk * kChunkPoints;
+        const int last = (std::min)(first + kChunkPoints, count);
+        transformPoints(transform, &x[first], &y[first], &z[first], last - first,
+            &screenX[first], &screenY[first], &depth[first]);
+        for (int i = first; i < last; i++) {
+            float d = depth[i];
+            float margin = pointSize / d;
+            // Written so that NaN ends up culled too
+            bool visible = d >= nearDepth && d <= farDepth &&
+                screenX[i] >= -margin && screenX[i] <= width + margin &&
+                screenY[i] >= -margin && screenY[i] <= height + margin;
+            keys[i] = visible ? (std::min)(static_cast<int>((farDepth - d) * bucketScale), kDepthBuckets - 1) : -1;
+        }
+    });
+    auto now = std::chrono::steady_clock::now();
+    stats.transformMs = std::chrono::duration<float, std::milli>(now - start).count();
+    start = now;
+
+    // Counting sort: bucket sizes, their offsets, then every point into place
+    bucketStart.assign(kDepthBuckets + 1, 0);
+    for (int i = 0; i < count; i++) {
+        if (keys[i] >= 0) bucketStart[keys[i] + 1]++;
+    }
+    for (int b = 0; b < kDepthBuckets; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    const int drawn = bucketStart[kDepthBuckets];
+    order.resize(drawn);
+    for (int i = 0; i < count; i++) {
+        if (keys[i] >= 0) order[bucketStart[keys[i]]++] = i;
+    }
+    stats.drawn = drawn;
+    now = std::chrono::steady_clock::now();
+    stats.sortMs = std::chrono::duration<float, std::milli>(now - start).count();
+    start = now;
+
+    // Sprites in the sorted order, written in place by chunks
+    geometry.clear();
+    geometry.addSprites(drawn);
+    const int geometryChunks = (drawn + kChunkPoints - 1) / kChunkPoints;
+    const float fadeScale = (1.0f - farAlpha) / (farDepth - nearDepth);
+    pool.parallelFor(geometryChunks, [&](int chunk) {
+        const int last = (std::min)((chunk + 1) * kChunkPoints, drawn);
+        for (int j = chunk * kChunkPoints; j < last; j++) {
+            const int i = order[j];
+            SDL_Color color = colors[i];
+            color.a = static_cast<Uint8>(color.a * (1.0f - (depth[i] - nearDepth) * fadeScale));
+            geometry.setSprite(j, screenX[i], screenY[i], pointSize / depth[i], color);
+        }
+    });
+    stats.geometryMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,92 @@
+#ifndef POINT_CLOUD_H
+#define POINT_CLOUD_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "curve_geometry.h"
+#include "thread_pool.h"
+
+struct Vector3D { float x, y, z; };
+
+// Row-major, applied to column vectors (x, y, z, 1)
+struct Matrix4 {
+    float m[4][4];
+
+    static Matrix4 identity();
+    static Matrix4 translation(const Vector3D& offset);
+    static Matrix4 rotationX(float angle);
+    static Matrix4 rotationY(float angle);
+    // Camera at the origin looking down +z, `focal` pixels per unit at
+    // distance 1, the view axis through (centerX, centerY) on screen.
+    // w of the result is the distance along the view axis.
+    static Matrix4 perspective(float focal, float centerX, float centerY);
+
+    Matrix4 operator*(const Matrix4& other) const;
+};
+
+// Transforms `count` points by `m` and divides by w: screen position in
+// sx/sy, w in depth. The third row of `m` is not used.
+void transformPoints(const Matrix4& m, const float* x, const float* y, const float* z, int count,
+    float* sx, float* sy, float* depth);
+
+struct PointCloudStats {
+    int points;
+    int drawn;            // in front of the camera, inside the depth range and on screen
+    float transformMs;
+    float sortMs;
+    float geometryMs;
+};
+
+// Large batches of 3D points drawn as small sprites with alpha blending,
+// back to front. Positions and colors are kept as separate arrays so the
+// transform runs four points at a time over contiguous memory; it and the
+// sprite geometry are split into chunks across the thread pool. The depth
+// order comes from a counting sort over quantized depth, linear in the
+// point count: points that land in the same one of its 4096 buckets are
+// too close in depth for their blend order to show.
+//
+// Fill the cloud with allocate() every frame, then render() and draw().
+class PointCloud {
+private:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<SDL_Color> colors;
+
+    // Per frame
+    std::vector<float> screenX;
+    std::vector<float> screenY;
+    std::vector<float> depth;
+    std::vector<int> keys;          // depth bucket, -1 when culled
+    std::vector<int> bucketStart;
+    std::vector<int> order;         // back to front
+    CurveGeometry geometry;
+    PointCloudStats stats;
+
+public:
+    PointCloud();
+
+    void clear();
+    // Adds `count` points and returns the index of the first. Positions and
+    // colors are uninitialized until written through the arrays below.
+    int allocate(int count);
+    int size() const { return static_cast<int>(x.size()); }
+    float* getX() { return x.data(); }
+    float* getY() { return y.data(); }
+    float* getZ() { return z.data(); }
+    SDL_Color* getColors() { return colors.data(); }
+
+    // Projects every point with `transform` (ending in a perspective) and
+    // builds the sprites for a width x height screen. Points outside
+    // nearDepth..farDepth are dropped, the rest fade with depth down to
+    // `farAlpha` of their own alpha. `pointSize` is the half size in pixels
+    // at depth 1.
+    void render(ThreadPool& pool, const Matrix4& transform, int width, int height, float pointSize,
+        float nearDepth, float farDepth, float farAlpha);
+    bool draw(SDL_Renderer* renderer) const { return geometry.draw(renderer); }
+
+    const CurveGeometry& getGeometry() const { return geometry; }
+    const PointCloudStats& getStats() const { return stats; }
+};
+
+#endif // POINT_CLOUD_H
@@ -0,0 +1,274 @@
+// signal_generator.cpp
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "signal_generator.h"
+
+// Declare writeDebugLog as extern to use the implementation from engine.cpp
+extern void writeDebugLog(const std::string& message);
+
+namespace {
+    const int kBlockSize = 256;
+    const float kTwoPi = 6.28318530718f;
+
+    // sin(2*pi*x) for any x in cycles: wrap to [-0.5, 0.5), fold into
+    // [-pi/2, pi/2] and evaluate a degree-9 Taylor polynomial (|err| < 4e-6).
+    // Branch free so the block loops below vectorize.
+    inline float sinCycles(float x) {
+        float r = x - std::floor(x + 0.5f);
+        float y = r * kTwoPi;
+        const float halfPi = 1.57079632679f;
+        const float pi = 3.14159265359f;
+        y = y > halfPi ? pi - y : y;
+        y = y < -halfPi ? -pi - y : y;
+        float y2 = y * y;
+        return y * (1.0f + y2 * (-1.0f / 6.0f + y2 * (1.0f / 120.0f +
+            y2 * (-1.0f / 5040.0f + y2 * (1.0f / 362880.0f)))));
+    }
+
+    inline float nextNoise(uint32_t& state) {
+        // xorshift32, mapped to [-1, 1)
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (float)(state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
+    inline double fraction(double x) {
+        return x - std::floor(x);
+    }
+}
+
+SignalGenerator::SignalGenerator(int sampleRate, uint32_t seed) : sampleRate(sampleRate),
+seed(seed ? seed : 1), sampleIndex(0) {
+    block.resize(kBlockSize);
+}
+
+SignalGenerator::~SignalGenerator() {
+    shutdown();
+}
+
+void SignalGenerator::clearVoices() {
+    voices.clear();
+}
+
+void SignalGenerator::addVoice(const SignalVoice& voice) {
+    VoiceState state;
+    state.voice = voice;
+    state.rng = 1;
+    state.pink[0] = state.pink[1] = state.pink[2] = 0.0f;
+    voices.push_back(state);
+    reset();
+}
+
+void SignalGenerator::addSine(float frequency, float gain) {
+    addVoice({ SignalType::Sine, gain, frequency, frequency, 0.0f });
+}
+
+void SignalGenerator::addSweep(float startFrequency, float endFrequency, float seconds, float gain) {
+    addVoice({ SignalType::Sweep, gain, startFrequency, endFrequency, seconds });
+}
+
+void SignalGenerator::addNoise(bool pink, float gain) {
+    addVoice({ pink ? SignalType::PinkNoise : SignalType::WhiteNoise, gain, 0.0f, 0.0f, 0.0f });
+}
+
+void SignalGenerator::addClicks(float bpm, float gain) {
+    addVoice({ SignalType::ClickTrain, gain, 0.0f, 0.0f, 60.0f / bpm });
+}
+
+void SignalGenerator::addKicks(float bpm, float gain) {
+    addVoice({ SignalType::KickDrum, gain, 55.0f, 55.0f, 60.0f / bpm });
+}
+
+void SignalGenerator::loadPreset(SignalPreset preset) {
+    clearVoices();
+    switch (preset) {
+    case SignalPreset::Demo:
+        // The old simulation chord, plus a four-on-the-floor kick and 8th-note hats
+        addSine(60.0f, 0.10f);
+        addSine(440.0f, 0.06f);
+        addSine(2000.0f, 0.03f);
+        addKicks(120.0f, 0.10f);
+        addClicks(240.0f, 0.03f);
+        break;
+    case SignalPreset::SineSweep:
+        addSweep(20.0f, 20000.0f, 10.0f, 0.25f);
+        break;
+    case SignalPreset::PinkNoise:
+        addNoise(true, 0.25f);
+        break;
+    case SignalPreset::Kicks120:
+        addKicks(120.0f, 0.30f);
+        break;
+    case SignalPreset::Silence:
+        break;
+    }
+    reset();
+}
+
+void SignalGenerator::reset() {
+    sampleIndex = 0;
+    for (size_t i = 0; i < voices.size(); i++) {
+        uint32_t state = seed ^ (uint32_t)((i + 1) * 0x9E3779B9u);
+        voices[i].rng = state ? state : 1;
+        voices[i].pink[0] = voices[i].pink[1] = voices[i].pink[2] = 0.0f;
+    }
+}
+
+void SignalGenerator::renderVoice(VoiceState& state, float* out, int count) {
+    const SignalVoice& v = state.voice;
+    const float invRate = 1.0f / sampleRate;
+    const double startTime = (double)sampleIndex / sampleRate;
+
+    switch (v.type) {
+    case SignalType::Silence:
+        break;
+
+    case SignalType::Sine: {
+        float phase = (float)fraction(v.frequency * startTime);
+        float increment = v.frequency * invRate;
+        for (int i = 0; i < count; i++) {
+            out[i] += v.gain * sinCycles(phase + i * increment);
+        }
+        break;
+    }
+
+    case SignalType::Sweep: {
+        // Exponential sweep, restarting every period:
+        // phase(t) = K * (exp(t / L) - 1), L = T / ln(f1 / f0), K = f0 * L
+        const double T = v.period;
+        const double L = T / std::log((double)v.endFrequency / v.frequency);
+        const double K = v.frequency * L;
+        int done = 0;
+        while (done < count) {
+            double t0 = std::fmod(startTime + done * (double)invRate, T);
+            int untilWrap = (int)std::ceil((T - t0) * sampleRate);
+            int n = std::min(count - done, std::max(1, untilWrap));
+            double growth = std::exp(t0 / L);
+            float basePhase = (float)fraction(K * (growth - 1.0));
+            float scale = (float)(K * growth);
+            float invL = (float)(1.0 / L);
+            float* dst = out + done;
+            for (int i = 0; i < n; i++) {
+                float offset = scale * (std::exp(i * invRate * invL) - 1.0f);
+                dst[i] += v.gain * sinCycles(basePhase + offset);
+            }
+            done += n;
+        }
+        break;
+    }
+
+    case SignalType::WhiteNoise:
+        for (int i = 0; i < count; i++) {
+            out[i] += v.gain * nextNoise(state.rng);
+        }
+        break;
+
+    case SignalType::PinkNoise: {
+        // Paul Kellet's economy filter, about -3 dB/octave
+        float b0 = state.pink[0], b1 = state.pink[1], b2 = state.pink[2];
+        for (int i = 0; i < count; i++) {
+            float white = nextNoise(state.rng);
+            b0 = 0.99765f * b0 + white * 0.0990460f;
+            b1 = 0.96300f * b1 + white * 0.2965164f;
+            b2 = 0.57000f * b2 + white * 1.0526913f;
+            out[i] += v.gain * 0.25f * (b0 + b1 + b2 + white * 0.1848f);
+        }
+        state.pink[0] = b0;
+        state.pink[1] = b1;
+        state.pink[2] = b2;
+        break;
+    }
+
+    case SignalType::ClickTrain: {
+        // 3 ms bursts of decaying noise on every period
+        const uint64_t periodSamples = std::max<uint64_t>(1, (uint64_t)std::llround(v.period * sampleRate));
+        const float clickSamples = 0.003f * sampleRate;
+        uint64_t position = sampleIndex % periodSamples;
+        for (int i = 0; i < count; i++) {
+            float noise = nextNoise(state.rng);
+            float envelope = std::max(0.0f, 1.0f - position / clickSamples);
+            out[i] += v.gain * envelope * noise;
+            if (++position == periodSamples) position = 0;
+        }
+        break;
+    }
+
+    case SignalType::KickDrum: {
+        // Sine body gliding from 3x down to the base frequency, exponential decay
+        const uint64_t periodSamples = std::max<uint64_t>(1, (uint64_t)std::llround(v.period * sampleRate));
+        const float body = v.frequency;
+        const float glide = 2.0f * v.frequency;
+        const float pitchRate = 30.0f;
+        const float ampRate = 12.0f;
+        uint64_t position = sampleIndex % periodSamples;
+        for (int i = 0; i < count; i++) {
+            float t = position * invRate;
+            float phase = body * t + glide * (1.0f - std::exp(-t * pitchRate)) / pitchRate;
+            out[i] += v.gain * std::exp(-t * ampRate) * sinCycles(phase);
+            if (++position == periodSamples) position = 0;
+        }
+        break;
+    }
+    }
+}
+
+void SignalGenerator::render(float* stereo, size_t frames) {
+    size_t done = 0;
+    while (done < frames) {
+        int count = (int)std::min<size_t>(kBlockSize, frames - done);
+        std::fill(block.begin(), block.begin() + count, 0.0f);
+        for (auto& voice : voices) {
+            renderVoice(voice, block.data(), count);
+        }
+
+        float* dst = stereo + done * 2;
+        for (int i = 0; i < count; i++) {
+            dst[i * 2] = block[i];
+            dst[i * 2 + 1] = block[i];
+        }
+        sampleIndex += count;
+        done += count;
+    }
+}
+
+bool SignalGenerator::initialize(Callback cb) {
+    shutdown();
+    userCallback = cb;
+    running = true;
+    renderThread = std::thread(&SignalGenerator::renderLoop, this);
+    writeDebugLog("Synthetic signal generator started (" + std::to_string(voices.size()) + " voices)");
+    return true;
+}
+
+void SignalGenerator::shutdown() {
+    running = false;
+    if (renderThread.joinable()) {
+        renderThread.join();
+    }
+}
+
+void SignalGenerator::renderLoop() {
+    // Deliver samples at the real-time rate, in roughly 10 ms packets like WASAPI
+    std::vector<float> stereo;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t delivered = 0;
+
+    while (running) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t due = (uint64_t)(elapsed * sampleRate);
+        if (due > delivered) {
+            size_t frames = (size_t)std::min<uint64_t>(due - delivered, sampleRate / 10);
+            stereo.resize(frames * 2);
+            render(stereo.data(), frames);
+            if (userCallback) userCallback(stereo.data(), frames);
+            delivered += frames;
+            if (due - delivered > (uint64_t)sampleRate / 10) {
+                delivered = due; // fell far behind, drop the backlog rather than burst it
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
@@ -0,0 +1,76 @@
+// signal_generator.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "audio_source.h"
+
+enum class SignalType { Silence, Sine, Sweep, WhiteNoise, PinkNoise, ClickTrain, KickDrum };
+
+// Ready-made mixes for simulation mode and analysis benchmarks
+enum class SignalPreset { Demo, SineSweep, PinkNoise, Kicks120, Silence };
+
+struct SignalVoice {
+    SignalType type;
+    float gain;
+    float frequency;     // Hz; start frequency of a sweep, body of a kick
+    float endFrequency;  // Hz; sweep end
+    float period;        // seconds; sweep length or time between clicks/kicks
+};
+
+// Deterministic bank of oscillators, noise sources, sweeps and click/kick
+// trains. All voices are rendered a block at a time and noise comes from a
+// seeded xorshift, so the same seed always produces the same samples. The
+// sine and sweep voices are closed-form functions of the sample index with
+// no carried state, so their loops vectorize; the noise, pink noise, click
+// and kick loops carry the generator, filter or period position from one
+// sample to the next and stay serial. Can run as a real-time AudioSource on
+// its own thread, or be pulled with render() as fast as the caller wants.
+class SignalGenerator : public AudioSource {
+private:
+    struct VoiceState {
+        SignalVoice voice;
+        uint32_t rng;
+        float pink[3]; // Kellet pink-noise filter poles
+    };
+
+    int sampleRate;
+    uint32_t seed;
+    uint64_t sampleIndex;
+    std::vector<VoiceState> voices;
+    std::vector<float> block;
+
+    std::thread renderThread;
+    std::atomic<bool> running{ false };
+    Callback userCallback;
+
+    void renderVoice(VoiceState& state, float* out, int count);
+    void renderLoop();
+
+public:
+    explicit SignalGenerator(int sampleRate = 44100, uint32_t seed = 1);
+    ~SignalGenerator();
+
+    void clearVoices();
+    void addVoice(const SignalVoice& voice);
+    void addSine(float frequency, float gain);
+    void addSweep(float startFrequency, float endFrequency, float seconds, float gain);
+    void addNoise(bool pink, float gain);
+    void addClicks(float bpm, float gain);
+    void addKicks(float bpm, float gain);
+    void loadPreset(SignalPreset preset);
+
+    // Rewind to sample 0 and reseed, the next render() repeats from the start
+    void reset();
+
+    // Interleaved stereo (both channels equal), advances the generator's clock
+    void render(float* stereo, size_t frames);
+
+    bool initialize(Callback cb) override;
+    void shutdown() override;
+
+    int getSampleRate() const { return sampleRate; }
+    double getTime() const { return (double)sampleIndex / sampleRate; }
+};
@@ -0,0 +1,93 @@
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "spectrogram_ring.h"
+
+namespace {
+    const int kFrameAlignFloats = 8; // 32 bytes, one AVX register
+}
+
+SpectrogramRing::SpectrogramRing() : storage(nullptr), capacityFrames(0), binCount(0),
+frameStride(0), writeIndex(0), frameCount(0), hopLength(0.0f) {
+}
+
+SpectrogramRing::~SpectrogramRing() {
+    release();
+}
+
+void SpectrogramRing::release() {
+    if (storage) {
+        SDL_SIMDFree(storage);
+        storage = nullptr;
+    }
+    capacityFrames = 0;
+    frameCount = 0;
+    writeIndex = 0;
+}
+
+bool SpectrogramRing::configure(int bins, float historySeconds, float hopSeconds) {
+    release();
+    if (bins <= 0 || historySeconds <= 0.0f || hopSeconds <= 0.0f) return false;
+
+    binCount = bins;
+    frameStride = (bins + kFrameAlignFloats - 1) / kFrameAlignFloats * kFrameAlignFloats;
+    hopLength = hopSeconds;
+    capacityFrames = std::max(1, static_cast<int>(std::ceil(historySeconds / hopSeconds)));
+
+    size_t bytes = sizeof(float) * frameStride * capacityFrames * 2;
+    storage = static_cast<float*>(SDL_SIMDAlloc(bytes));
+    if (!storage) {
+        capacityFrames = 0;
+        return false;
+    }
+    clear();
+    return true;
+}
+
+void SpectrogramRing::clear() {
+    if (storage) {
+        memset(storage, 0, sizeof(float) * frameStride * capacityFrames * 2);
+    }
+    writeIndex = 0;
+    frameCount = 0;
+}
+
+void SpectrogramRing::push(const float* spectrum) {
+    if (!storage) return;
+
+    float* first = storage + writeIndex * frameStride;
+    float* mirror = first + capacityFrames * frameStride;
+    memcpy(first, spectrum, sizeof(float) * binCount);
+    memcpy(mirror, spectrum, sizeof(float) * binCount);
+
+    writeIndex = (writeIndex + 1) % capacityFrames;
+    frameCount = std::min(frameCount + 1, capacityFrames);
+}
+
+SpectrogramView SpectrogramRing::view(int frames, int age) const {
+    SpectrogramView result = { storage, 0, binCount, frameStride };
+    age = std::max(0, age);
+    frames = std::min(frames, frameCount - age);
+    if (!storage || frames <= 0) return result;
+
+    // Slot of the newest frame in the window, then step back into the
+    // mirrored half so the whole window is in range without wrapping
+    int end = writeIndex - 1 - age;
+    int start = end - frames + 1;
+    if (start < 0) start += capacityFrames;
+
+    result.data = storage + start * frameStride;
+    result.frames = frames;
+    return result;
+}
+
+SpectrogramView SpectrogramRing::lastSeconds(float seconds) const {
+    int frames = hopLength > 0.0f ? static_cast<int>(std::ceil(seconds / hopLength)) : 0;
+    return view(frames);
+}
+
+const float* SpectrogramRing::newest() const {
+    if (frameCount == 0) return nullptr;
+    return view(1).data;
+}
@@ -0,0 +1,56 @@
+#ifndef SPECTROGRAM_RING_H
+#define SPECTROGRAM_RING_H
+
+// Read-only window over consecutive spectrogram frames, oldest first.
+// Frames are contiguous and `stride` floats apart (bins padded to SIMD width).
+struct SpectrogramView {
+    const float* data;
+    int frames;
+    int bins;
+    int stride;
+
+    const float* frame(int index) const { return data + index * stride; }
+    bool empty() const { return frames == 0; }
+};
+
+// Fixed-capacity history of past spectra. Storage is allocated once,
+// aligned and frame-major; every frame is written twice (at i and
+// i + capacity) so any window of up to `capacity` frames is a single
+// contiguous block and can be handed out without copying.
+class SpectrogramRing {
+private:
+    float* storage;
+    int capacityFrames;
+    int binCount;
+    int frameStride;
+    int writeIndex;   // slot the next frame goes to, in [0, capacity)
+    int frameCount;
+    float hopLength;
+
+    void release();
+
+public:
+    SpectrogramRing();
+    ~SpectrogramRing();
+
+    SpectrogramRing(const SpectrogramRing&) = delete;
+    SpectrogramRing& operator=(const SpectrogramRing&) = delete;
+
+    // (Re)allocates and clears; history is rounded up to whole hops
+    bool configure(int bins, float historySeconds, float hopSeconds);
+    void clear();
+    void push(const float* spectrum);
+
+    // `frames` consecutive frames ending `age` hops before the newest one
+    // (age 0 = up to and including the newest). Clamped to what is stored.
+    SpectrogramView view(int frames, int age = 0) const;
+    SpectrogramView lastSeconds(float seconds) const;
+    const float* newest() const;
+
+    int size() const { return frameCount; }
+    int capacity() const { return capacityFrames; }
+    int bins() const { return binCount; }
+    float hopSeconds() const { return hopLength; }
+};
+
+#endif // SPECTROGRAM_RING_H
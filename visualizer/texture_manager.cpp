@@ -0,0 +1,135 @@
+#include <string>
+#include "texture_manager.h"
+
+// Declare writeDebugLog as extern to use the implementation from engine.cpp
+extern void writeDebugLog(const std::string& message);
+
+namespace {
+    const unsigned int kIdleFrames = 300;   // about 5 s at 60 fps
+    const size_t kMaxPooled = 4;             // oldest pooled textures go first beyond this
+}
+
+TextureManager::TextureManager() : renderer(nullptr), frame(0), createdCount(0), reusedCount(0),
+evictedCount(0) {
+}
+
+TextureManager::~TextureManager() {
+    clear();
+}
+
+size_t TextureManager::bytesFor(const Key& key) {
+    return (size_t)key.width * key.height * SDL_BYTESPERPIXEL(key.format);
+}
+
+void TextureManager::destroy(size_t index) {
+    SDL_DestroyTexture(entries[index].texture);
+    entries.erase(entries.begin() + index);
+}
+
+void TextureManager::setRenderer(SDL_Renderer* newRenderer) {
+    if (newRenderer == renderer) return;
+    clear();
+    renderer = newRenderer;
+}
+
+SDL_Texture* TextureManager::acquire(const std::string& slot, Uint32 format, int access, int width,
+    int height, bool* fresh) {
+    if (fresh) *fresh = false;
+    if (!renderer || width <= 0 || height <= 0) return nullptr;
+
+    const Key key = { format, access, width, height };
+    for (auto& entry : entries) {
+        if (entry.slot == slot) {
+            if (entry.key == key) {
+                entry.lastUsed = frame;
+                return entry.texture;
+            }
+            // Wrong size or kind: back to the pool, maybe wanted again soon
+            entry.slot.clear();
+            entry.lastUsed = frame;
+            break;
+        }
+    }
+
+    if (fresh) *fresh = true;
+    for (auto& entry : entries) {
+        if (entry.slot.empty() && entry.key == key) {
+            entry.slot = slot;
+            entry.lastUsed = frame;
+            reusedCount++;
+            return entry.texture;
+        }
+    }
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, format, access, width, height);
+    if (!texture) {
+        writeDebugLog("Texture creation failed for '" + slot + "' (" + std::to_string(width) + "x" +
+            std::to_string(height) + "): " + SDL_GetError());
+        return nullptr;
+    }
+    Entry entry = { key, texture, slot, frame };
+    entries.push_back(entry);
+    createdCount++;
+    return texture;
+}
+
+void TextureManager::release(const std::string& slot) {
+    for (auto& entry : entries) {
+        if (entry.slot == slot) {
+            entry.slot.clear();
+            entry.lastUsed = frame;
+            return;
+        }
+    }
+}
+
+void TextureManager::endFrame() {
+    frame++;
+
+    size_t pooled = 0;
+    for (size_t i = entries.size(); i-- > 0;) {
+        if (!entries[i].slot.empty()) continue;
+        if (frame - entries[i].lastUsed > kIdleFrames) {
+            destroy(i);
+            evictedCount++;
+        }
+        else {
+            pooled++;
+        }
+    }
+
+    while (pooled > kMaxPooled) {
+        size_t oldest = entries.size();
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].slot.empty() && (oldest == entries.size() || entries[i].lastUsed < entries[oldest].lastUsed)) {
+                oldest = i;
+            }
+        }
+        destroy(oldest);
+        evictedCount++;
+        pooled--;
+    }
+}
+
+void TextureManager::clear() {
+    for (auto& entry : entries) {
+        SDL_DestroyTexture(entry.texture);
+    }
+    entries.clear();
+}
+
+size_t TextureManager::getTotalBytes() const {
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        total += bytesFor(entry.key);
+    }
+    return total;
+}
+
+size_t TextureManager::getPooledBytes() const {
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        if (entry.slot.empty()) total += bytesFor(entry.key);
+    }
+    return total;
+}
@@ -0,0 +1,78 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Owns every render target and streaming texture of the visualizer.
+//
+// Layers ask for their texture by slot name every frame, with the format,
+// access and size they need right now. While those stay the same the slot
+// keeps its texture. When they change (dynamic resolution steps, window
+// resizes) the old texture goes back to a pool keyed by (format, access,
+// width, height) and the slot gets a pooled match or a new texture, so
+// flipping between two scales reuses both instead of reallocating. Pooled
+// textures nobody picked up for a few seconds are destroyed in endFrame().
+class TextureManager {
+private:
+    struct Key {
+        Uint32 format;
+        int access;
+        int width;
+        int height;
+
+        bool operator==(const Key& other) const {
+            return format == other.format && access == other.access &&
+                width == other.width && height == other.height;
+        }
+    };
+
+    struct Entry {
+        Key key;
+        SDL_Texture* texture;
+        std::string slot;        // empty while pooled
+        unsigned int lastUsed;   // frame number
+    };
+
+    SDL_Renderer* renderer;
+    std::vector<Entry> entries;   // a handful, searched linearly
+    unsigned int frame;
+    unsigned int createdCount;
+    unsigned int reusedCount;
+    unsigned int evictedCount;
+
+    static size_t bytesFor(const Key& key);
+    void destroy(size_t index);
+
+public:
+    TextureManager();
+    ~TextureManager();
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // Textures belong to one renderer; switching destroys all of them
+    void setRenderer(SDL_Renderer* newRenderer);
+
+    // The slot's texture with the given properties, or nullptr if it could
+    // not be created (logged). `fresh` is set when the slot got a different
+    // texture than last time: its contents and blend mode are undefined.
+    SDL_Texture* acquire(const std::string& slot, Uint32 format, int access, int width, int height,
+        bool* fresh = nullptr);
+    // Hands the slot's texture back to the pool
+    void release(const std::string& slot);
+
+    // Call once per frame, after presenting
+    void endFrame();
+    void clear();
+
+    size_t getTotalBytes() const;
+    size_t getPooledBytes() const;
+    int getTextureCount() const { return static_cast<int>(entries.size()); }
+    unsigned int getCreatedCount() const { return createdCount; }
+    unsigned int getReusedCount() const { return reusedCount; }
+    unsigned int getEvictedCount() const { return evictedCount; }
+};
+
+#endif // TEXTURE_MANAGER_H
@@ -0,0 +1,74 @@
+#include <SDL2/SDL.h>
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads) : job(nullptr), jobCount(0), nextItem(0),
+busyWorkers(0), generation(0), stopping(false) {
+    if (threads <= 0) {
+        threads = SDL_GetCPUCount();
+    }
+    if (threads < 1) threads = 1;
+
+    workers.reserve(threads);
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ThreadPool::drain() {
+    for (;;) {
+        int item = nextItem.fetch_add(1, std::memory_order_relaxed);
+        if (item >= jobCount) break;
+        (*job)(item);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned int seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            jobFinished.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& fn) {
+    if (count <= 0) return;
+    if (count == 1) {
+        fn(0);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &fn;
+    jobCount = count;
+    nextItem.store(0, std::memory_order_relaxed);
+    busyWorkers = static_cast<int>(workers.size());
+    generation++;
+    wakeWorkers.notify_all();
+
+    // Every worker checks in once per job, even if the items ran out
+    // before it woke, so `job` stays valid until the last one is done
+    jobFinished.wait(lock, [&] { return busyWorkers == 0; });
+    job = nullptr;
+}
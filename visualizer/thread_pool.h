@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork/join work on the render thread.
+//
+// parallelFor() publishes one job of `count` independent items and blocks
+// until every item has run. Workers pull item indices from a shared atomic
+// counter, so uneven items (tiles near the screen center, busy layers)
+// balance themselves without any per-item queueing or allocation.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobFinished;
+
+    const std::function<void(int)>* job;
+    int jobCount;
+    std::atomic<int> nextItem;
+    int busyWorkers;
+    unsigned int generation;   // bumped for every job so workers can tell a new one arrived
+    bool stopping;
+
+    void workerLoop();
+    void drain();
+
+public:
+    // threads <= 0 uses one worker per logical CPU
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs fn(0) .. fn(count - 1) across the workers and returns when all
+    // are done. The calling thread only waits. Not reentrant.
+    void parallelFor(int count, const std::function<void(int)>& fn);
+
+    int size() const { return static_cast<int>(workers.size()); }
+};
+
+#endif // THREAD_POOL_H
@@ -6,16 +6,15 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include "audio_source.h"
 
-class WASAPICapture {
+class WASAPICapture : public AudioSource {
 public:
-    using Callback = std::function<void(const float* data, size_t frames)>;
-
     WASAPICapture();
     ~WASAPICapture();
 
-    bool initialize(Callback cb);
-    void shutdown();
+    bool initialize(Callback cb) override;
+    void shutdown() override;
 
 private:
     void captureLoop();